@@ -0,0 +1,388 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 	 [简介] 按 align 对齐分配内存, 用 aligned_free 释放
+ * @param 	 bytes [in], 字节数
+ * @param 	 align [in], 对齐字节数, 2 的幂且不小于 sizeof(void*)
+ * @return 	 [void*] 返回内存地址, 失败时抛出 std::bad_alloc
+ */
+inline void *aligned_malloc(size_t bytes, size_t align)
+{
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, align, bytes == 0 ? align : bytes) != 0) throw std::bad_alloc();
+    return ptr;
+}
+
+inline void aligned_free(void *ptr) { std::free(ptr); }
+
+/**
+ * @brief 	 [简介] 按 alignof(T) 对齐的标准分配器, 与 Eigen::aligned_allocator 作用相同, 不依赖 Eigen
+ * @note 	 [注意] C++14 的 std::allocator 只保证 16 字节对齐, 容器中存放 Eigen::Vector4d 等向量化类型(或含有它们的结构体)时使用;
+ *                  也可以用于 std::allocate_shared
+ */
+template <typename T>
+struct AlignedAllocator
+{
+    using value_type = T;
+
+    AlignedAllocator() = default;
+    template <typename U> AlignedAllocator(const AlignedAllocator<U>&) { }
+
+    T *allocate(size_t num) { return static_cast<T*>(aligned_malloc(num * sizeof(T), alignof(T) > sizeof(void*) ? alignof(T) : sizeof(void*))); }
+    void deallocate(T *ptr, size_t) { aligned_free(ptr); }
+
+    template <typename U> bool operator==(const AlignedAllocator<U>&) const { return true; }
+    template <typename U> bool operator!=(const AlignedAllocator<U>&) const { return false; }
+};
+
+template <typename T> using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+/**
+ * @brief 	 [简介] 内存块的对齐: 至少按缓存行对齐, 同时满足对象本身的对齐要求(如 Eigen 的向量化类型)
+ */
+template <typename T>
+constexpr size_t block_align() { return alignof(T) > 64 ? alignof(T) : 64; }
+
+/**
+ * @brief 	 [简介] 按块分配的对象内存池, 对象地址在内存池生命周期内保持不变
+ * @note 	 [注意] 内存池只管理内存, 不记录哪些对象存活; 对象的析构由使用者通过 destroy 完成,
+ *                  release 只归还内存块; 内存块按 block_align 对齐, 对象满足 alignof(T)
+ */
+template <typename T, size_t BlockSize = 256>
+class Arena {
+public:
+    Arena() : cursor_(BlockSize), live_(0) { }
+    ~Arena() { release(); }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    Arena(Arena&& other) noexcept
+        : blocks_(std::move(other.blocks_)), free_(std::move(other.free_)),
+          cursor_(other.cursor_), live_(other.live_)
+    {
+        other.reset();
+    }
+
+    Arena& operator=(Arena&& other) noexcept
+    {
+        if (this != &other) {
+            release();
+            blocks_ = std::move(other.blocks_);
+            free_ = std::move(other.free_);
+            cursor_ = other.cursor_;
+            live_ = other.live_;
+            other.reset();
+        }
+        return *this;
+    }
+
+    /**
+     * @brief 	 [简介] 在内存池中构造对象
+     * @param 	 args [in], 构造参数
+     * @return 	 [T*] 返回对象指针
+     */
+    template <typename... Args>
+    T *create(Args&&... args)
+    {
+        T *slot = allocate();
+        ++live_;
+        return new (slot) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief 	 [简介] 析构对象并回收其内存, 回收的内存会被之后的 create 复用
+     * @param 	 obj [in], 对象指针, 必须来自本内存池(或被 splice 进来的内存池)
+     */
+    void destroy(T *obj)
+    {
+        obj->~T();
+        free_.push_back(obj);
+        --live_;
+    }
+
+    /**
+     * @brief 	 [简介] 接管另一个内存池的全部内存块, other 变为空
+     * @param 	 other [in], 被接管的内存池
+     * @return 	 [size_t] 被接管对象的下标偏移, 指针不需要调整, 总是 0
+     * @note 	 [注意] 用于把多个线程各自分配的对象合并到一棵树中, 代价只与块数有关
+     */
+    size_t splice(Arena& other)
+    {
+        if (&other == this) return 0;
+        // 当前正在分配的块必须保持在末尾
+        blocks_.insert(blocks_.begin(), other.blocks_.begin(), other.blocks_.end());
+        free_.insert(free_.end(), other.free_.begin(), other.free_.end());
+        live_ += other.live_;
+        other.reset();
+        return 0;
+    }
+
+    /**
+     * @brief 	 [简介] 归还所有内存块, 不调用析构函数
+     */
+    void release()
+    {
+        for (T *block : blocks_) aligned_free(block);
+        reset();
+    }
+
+    /**
+     * @brief 	 [简介] 存活对象数量
+     */
+    size_t size() const { return live_; }
+
+    /**
+     * @brief 	 [简介] 内存池占用的字节数
+     */
+    size_t bytes() const { return blocks_.size() * BlockSize * sizeof(T); }
+private:
+    T *allocate()
+    {
+        if (!free_.empty()) {
+            T *slot = free_.back();
+            free_.pop_back();
+            return slot;
+        }
+        if (cursor_ == BlockSize) {
+            blocks_.push_back(static_cast<T*>(aligned_malloc(BlockSize * sizeof(T), block_align<T>())));
+            cursor_ = 0;
+        }
+        return blocks_.back() + cursor_++;
+    }
+
+    void reset()
+    {
+        blocks_.clear();
+        free_.clear();
+        cursor_ = BlockSize;
+        live_ = 0;
+    }
+private:
+    std::vector<T*> blocks_;
+    std::vector<T*> free_;
+    size_t cursor_;
+    size_t live_;
+};
+
+/**
+ * @brief 	 [简介] 按块分配并用 32 位下标引用对象的内存池
+ * @note 	 [注意] 下标 = 块号 * BlockSize + 块内偏移, 只与分配顺序有关, 与内存地址无关;
+ *                  对象地址同样在内存池生命周期内保持不变; 最多 2^32 - 1 个下标, npos 表示空引用;
+ *                  export_to/import_from 在块和一段连续内存之间按字节拷贝, 下标不变
+ */
+template <typename T, size_t BlockSize = 256>
+class IndexArena {
+    static_assert((BlockSize & (BlockSize - 1)) == 0, "BlockSize must be a power of two");
+public:
+    constexpr static uint32_t npos = 0xffffffffu;
+
+    IndexArena() : cursor_(BlockSize), live_(0) { }
+    ~IndexArena() { release(); }
+
+    IndexArena(const IndexArena&) = delete;
+    IndexArena& operator=(const IndexArena&) = delete;
+
+    IndexArena(IndexArena&& other) noexcept
+        : blocks_(std::move(other.blocks_)), order_(std::move(other.order_)), free_(std::move(other.free_)),
+          cursor_(other.cursor_), live_(other.live_)
+    {
+        other.reset();
+    }
+
+    IndexArena& operator=(IndexArena&& other) noexcept
+    {
+        if (this != &other) {
+            release();
+            blocks_ = std::move(other.blocks_);
+            order_ = std::move(other.order_);
+            free_ = std::move(other.free_);
+            cursor_ = other.cursor_;
+            live_ = other.live_;
+            other.reset();
+        }
+        return *this;
+    }
+
+    /**
+     * @brief 	 [简介] 在内存池中构造对象
+     * @param 	 args [in], 构造参数
+     * @return 	 [T*] 返回对象指针, 下标由 index_of 得到
+     */
+    template <typename... Args>
+    T *create(Args&&... args)
+    {
+        T *slot = allocate();
+        ++live_;
+        return new (slot) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief 	 [简介] 析构对象并回收其下标
+     * @param 	 obj [in], 对象指针, 必须来自本内存池(或被 splice 进来的内存池)
+     */
+    void destroy(T *obj)
+    {
+        uint32_t index = index_of(obj);
+        obj->~T();
+        free_.push_back(index);
+        --live_;
+    }
+
+    /**
+     * @brief 	 [简介] 按下标访问对象
+     */
+    T *at(uint32_t index) const { return blocks_[index / BlockSize] + index % BlockSize; }
+
+    /**
+     * @brief 	 [简介] 计算对象的下标
+     * @note 	 [注意] 最后一个块内的对象为常数时间, 其余按块地址二分查找
+     */
+    uint32_t index_of(const T *obj) const
+    {
+        std::less<const T*> less;
+        const T *last = blocks_.back();
+        if (!less(obj, last) && less(obj, last + BlockSize)) return uint32_t((blocks_.size() - 1) * BlockSize + (obj - last));
+
+        auto it = std::upper_bound(order_.begin(), order_.end(), obj,
+                                   [&less](const T *obj, const std::pair<const T*, uint32_t>& block) { return less(obj, block.first); });
+        --it;
+        return uint32_t(it->second * BlockSize + (obj - it->first));
+    }
+
+    /**
+     * @brief 	 [简介] 接管另一个内存池的全部内存块, other 变为空
+     * @param 	 other [in], 被接管的内存池
+     * @return 	 [size_t] 被接管对象的下标偏移, other 中下标为 i 的对象在本内存池中的下标为 i + 偏移
+     * @note 	 [注意] 被接管对象之间的下标引用需要由使用者加上偏移; 本内存池当前块的剩余位置进入空闲列表
+     */
+    size_t splice(IndexArena& other)
+    {
+        size_t offset = blocks_.size() * BlockSize;
+        if (&other == this || other.blocks_.empty()) return offset;
+
+        for (size_t i = cursor_; i < BlockSize; ++i) free_.push_back(uint32_t(offset - BlockSize + i));
+        for (T *block : other.blocks_) add_block(block);
+        for (uint32_t index : other.free_) free_.push_back(uint32_t(index + offset));
+        cursor_ = other.cursor_;
+        live_ += other.live_;
+        other.reset();
+        return offset;
+    }
+
+    /**
+     * @brief 	 [简介] 归还所有内存块, 不调用析构函数
+     */
+    void release()
+    {
+        for (T *block : blocks_) aligned_free(block);
+        reset();
+    }
+
+    /**
+     * @brief 	 [简介] 存活对象数量
+     */
+    size_t size() const { return live_; }
+
+    /**
+     * @brief 	 [简介] 内存池占用的字节数
+     */
+    size_t bytes() const { return blocks_.size() * BlockSize * sizeof(T); }
+
+    /**
+     * @brief 	 [简介] 已分配过的下标数(含空闲下标), 所有下标都小于它
+     */
+    size_t capacity() const { return blocks_.empty() ? 0 : (blocks_.size() - 1) * BlockSize + cursor_; }
+
+    /**
+     * @brief 	 [简介] 空闲下标, 这些位置的内容无意义
+     */
+    const std::vector<uint32_t>& free_list() const { return free_; }
+
+    /**
+     * @brief 	 [简介] 把下标 [0, capacity()) 的对象按字节拷贝到一段连续内存, 下标为 i 的对象在第 i 个位置
+     * @param 	 dst [out], 至少 capacity() * sizeof(T) 字节, 不要求对齐
+     * @note 	 [注意] 只做按字节拷贝, T 中不能有指针或堆内存
+     */
+    void export_to(void *dst) const
+    {
+        uint8_t *out = static_cast<uint8_t*>(dst);
+        for (size_t b = 0; b < blocks_.size(); ++b) {
+            size_t num = b + 1 == blocks_.size() ? cursor_ : BlockSize;
+            std::memcpy(out + b * BlockSize * sizeof(T), blocks_[b], num * sizeof(T));
+        }
+    }
+
+    /**
+     * @brief 	 [简介] 用连续内存中的 num 个对象替换内存池的内容, 与 export_to 相反, 下标不变
+     * @param 	 src [in], num * sizeof(T) 字节, 不要求对齐
+     * @param 	 num [in], 对象个数(含空闲位置)
+     * @param 	 free [in], 空闲下标, 都小于 num
+     * @note 	 [注意] 原有的内存块直接归还, 不调用析构函数
+     */
+    void import_from(const void *src, size_t num, std::vector<uint32_t> free)
+    {
+        release();
+        const uint8_t *in = static_cast<const uint8_t*>(src);
+        for (size_t begin = 0; begin < num; begin += BlockSize) {
+            add_block(static_cast<T*>(aligned_malloc(BlockSize * sizeof(T), block_align<T>())));
+            cursor_ = std::min(BlockSize, num - begin);
+            std::memcpy(static_cast<void*>(blocks_.back()), in + begin * sizeof(T), cursor_ * sizeof(T));
+        }
+        free_ = std::move(free);
+        live_ = num - free_.size();
+    }
+private:
+    T *allocate()
+    {
+        if (!free_.empty()) {
+            T *slot = at(free_.back());
+            free_.pop_back();
+            return slot;
+        }
+        if (cursor_ == BlockSize) {
+            add_block(static_cast<T*>(aligned_malloc(BlockSize * sizeof(T), block_align<T>())));
+            cursor_ = 0;
+        }
+        return blocks_.back() + cursor_++;
+    }
+
+    void add_block(T *block)
+    {
+        std::pair<const T*, uint32_t> entry(block, uint32_t(blocks_.size()));
+        auto it = std::upper_bound(order_.begin(), order_.end(), entry,
+                                   [](const std::pair<const T*, uint32_t>& a, const std::pair<const T*, uint32_t>& b) {
+                                       return std::less<const T*>()(a.first, b.first);
+                                   });
+        order_.insert(it, entry);
+        blocks_.push_back(block);
+    }
+
+    void reset()
+    {
+        blocks_.clear();
+        order_.clear();
+        free_.clear();
+        cursor_ = BlockSize;
+        live_ = 0;
+    }
+private:
+    std::vector<T*> blocks_;
+    std::vector<std::pair<const T*, uint32_t>> order_;     // 按地址排序的块, 用于由地址反查下标
+    std::vector<uint32_t> free_;
+    size_t cursor_;
+    size_t live_;
+};
+
+#endif // __ARENA_H__
@@ -0,0 +1,106 @@
+#ifndef __MPSC_QUEUE_H__
+#define __MPSC_QUEUE_H__
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include "core/tt_arena.h"
+
+/**
+ * @brief 	 [简介] 有界无锁多生产者单消费者队列(Vyukov 有界队列)
+ * @note 	 [注意] 单元在构造时一次性分配成环, push 不分配内存、不加锁, 只有一次 CAS, 队列满时立即返回 false;
+ *                  pop 只能在唯一的消费线程调用; 每个单元的序号表示它当前可写(等于入队位置)还是可读(入队位置 + 1)
+ */
+template <typename T>
+class MpscQueue {
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+public:
+    /**
+     * @brief 	 [简介] 构造函数
+     * @param 	 capacity [in], 容量, 向上取整为 2 的幂
+     */
+    explicit MpscQueue(size_t capacity) : mask_(round_up(capacity) - 1), enqueue_(0), dequeue_(0)
+    {
+        cells_ = static_cast<Cell*>(aligned_malloc((mask_ + 1) * sizeof(Cell), block_align<Cell>()));
+        for (size_t i = 0; i <= mask_; ++i) {
+            new (&cells_[i]) Cell();
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MpscQueue()
+    {
+        for (size_t i = 0; i <= mask_; ++i) cells_[i].~Cell();
+        aligned_free(cells_);
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /**
+     * @brief 	 [简介] 入队, 多生产者安全
+     * @param 	 value [in], 入队元素
+     * @return 	 [true] 成功 or [false] 队列已满, 元素未入队
+     */
+    bool push(T value)
+    {
+        size_t pos = enqueue_.load(std::memory_order_relaxed);
+        Cell *cell = nullptr;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            intptr_t diff = intptr_t(cell->sequence.load(std::memory_order_acquire)) - intptr_t(pos);
+            if (diff == 0) {
+                if (enqueue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 	 [简介] 出队, 只能由消费线程调用
+     * @param 	 value [out], 出队元素
+     * @return 	 [true] 取到元素 or [false] 队列为空(或生产者尚未写完)
+     */
+    bool pop(T& value)
+    {
+        Cell *cell = &cells_[dequeue_ & mask_];
+        if (cell->sequence.load(std::memory_order_acquire) != dequeue_ + 1) return false;
+
+        value = std::move(cell->value);
+        cell->sequence.store(dequeue_ + mask_ + 1, std::memory_order_release);
+        ++dequeue_;
+        return true;
+    }
+
+    /**
+     * @brief 	 [简介] 队列是否为空, 仅消费线程调用时结果可靠
+     */
+    bool empty() const { return cells_[dequeue_ & mask_].sequence.load(std::memory_order_acquire) != dequeue_ + 1; }
+
+    size_t capacity() const { return mask_ + 1; }
+private:
+    static size_t round_up(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        return size;
+    }
+private:
+    Cell *cells_;
+    size_t mask_;
+    std::atomic<size_t> enqueue_;   // 生产者竞争的入队位置
+    size_t dequeue_;                // 只有消费线程访问
+};
+
+#endif // __MPSC_QUEUE_H__
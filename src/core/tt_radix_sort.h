@@ -0,0 +1,152 @@
+#ifndef __RADIX_SORT_H__
+#define __RADIX_SORT_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "core/tt_thread_pool.h"
+
+/**
+ * @brief 	 [简介] 并行 LSD 基数排序
+ * @note 	 [注意] 数组分成连续的若干段, 每趟先并行统计每段的直方图, 汇总出每段在每个桶中的写入位置, 再并行把各段分发到目标数组;
+ *                  各段按顺序排列, 所以排序是稳定的; 所有元素在某一趟中落在同一个桶时跳过该趟;
+ *                  分发的开销主要是写目标数组时的缓存缺失, 每趟的耗时与桶数关系不大, 所以按有效位数取尽量少的趟数,
+ *                  每趟不超过 12 位(如 24 位的 Morton 编码 2 趟, 64 位的键 6 趟)
+ */
+template <typename Key, typename Value>
+class RadixSorter {
+    static_assert(std::is_unsigned<Key>::value && (sizeof(Key) == 4 || sizeof(Key) == 8), "32/64 bit unsigned keys");
+public:
+    constexpr static size_t max_radix_bits_ = 12;
+    constexpr static size_t min_chunk_ = 1 << 14;   // 每段至少的元素数, 更少时任务开销大于收益
+
+    RadixSorter(Key *keys, Value *values, size_t num, size_t key_bits, size_t chunks, ThreadPool& pool)
+        : keys_(keys), values_(values), num_(num), pool_(pool)
+    {
+        key_bits = std::min(key_bits, sizeof(Key) * 8);
+        passes_ = (key_bits + max_radix_bits_ - 1) / max_radix_bits_;
+        radix_bits_ = passes_ == 0 ? 0 : (key_bits + passes_ - 1) / passes_;
+        bucket_num_ = size_t(1) << radix_bits_;
+        if (chunks == 0) chunks = std::max<size_t>(pool_.size(), 1);
+        chunks_ = std::max<size_t>(std::min(chunks, num_ / min_chunk_), 1);
+        hist_.resize(chunks_ * bucket_num_);
+    }
+
+    void run()
+    {
+        if (num_ < 2 || passes_ == 0) return;
+        std::unique_ptr<Key[]> key_buffer(new Key[num_]);
+        std::unique_ptr<Value[]> value_buffer(values_ == nullptr ? nullptr : new Value[num_]);
+        Key *src = keys_, *dst = key_buffer.get();
+        Value *src_value = values_, *dst_value = value_buffer.get();
+
+        for (size_t pass = 0; pass < passes_; ++pass) {
+            size_t shift = pass * radix_bits_;
+            for_chunks([&](size_t c, size_t lo, size_t hi) { count(src, lo, hi, shift, &hist_[c * bucket_num_]); });
+            if (!offsets()) continue;
+            for_chunks([&](size_t c, size_t lo, size_t hi) {
+                scatter(src, src_value, dst, dst_value, lo, hi, shift, &hist_[c * bucket_num_]);
+            });
+            std::swap(src, dst);
+            std::swap(src_value, dst_value);
+        }
+
+        // 结果在临时数组中时拷贝回原数组
+        if (src != keys_) {
+            for_chunks([&](size_t, size_t lo, size_t hi) {
+                std::copy(src + lo, src + hi, keys_ + lo);
+                if (src_value != nullptr) std::copy(src_value + lo, src_value + hi, values_ + lo);
+            });
+        }
+    }
+private:
+    /**
+     * @brief 	 [简介] 每段一个任务, func 的参数为 (段号, 起点, 终点)
+     */
+    template <typename Func>
+    void for_chunks(const Func& func)
+    {
+        if (chunks_ == 1) {
+            func(0, 0, num_);
+            return;
+        }
+        pool_.parallel_for(0, chunks_, 1, [&](size_t lo, size_t hi) {
+            for (size_t c = lo; c < hi; ++c) func(c, num_ * c / chunks_, num_ * (c + 1) / chunks_);
+        });
+    }
+
+    void count(const Key *src, size_t lo, size_t hi, size_t shift, size_t *hist) const
+    {
+        const Key mask = Key(bucket_num_ - 1);
+        std::fill(hist, hist + bucket_num_, 0);
+        for (size_t j = lo; j < hi; ++j) ++hist[(src[j] >> shift) & mask];
+    }
+
+    /**
+     * @brief 	 [简介] 把各段的直方图原地换成各段在每个桶中的写入位置
+     * @return 	 [true] 需要分发 or [false] 所有元素在同一个桶中, 跳过这一趟
+     */
+    bool offsets()
+    {
+        size_t total = 0;
+        for (size_t b = 0; b < bucket_num_; ++b) {
+            size_t start = total;
+            for (size_t c = 0; c < chunks_; ++c) {
+                size_t count = hist_[c * bucket_num_ + b];
+                hist_[c * bucket_num_ + b] = total;
+                total += count;
+            }
+            if (total - start == num_) return false;
+        }
+        return true;
+    }
+
+    void scatter(const Key *src, const Value *src_value, Key *dst, Value *dst_value, size_t lo, size_t hi, size_t shift, size_t *offset) const
+    {
+        const Key mask = Key(bucket_num_ - 1);
+        for (size_t j = lo; j < hi; ++j) {
+            size_t to = offset[(src[j] >> shift) & mask]++;
+            dst[to] = src[j];
+            if (src_value != nullptr) dst_value[to] = src_value[j];
+        }
+    }
+private:
+    Key *keys_;
+    Value *values_;
+    size_t num_;
+    ThreadPool& pool_;
+    size_t passes_;
+    size_t radix_bits_;                     // 每趟处理的位数
+    size_t bucket_num_;
+    size_t chunks_;
+    std::vector<size_t> hist_;              // 第 c 段的直方图在 [c * bucket_num_, (c + 1) * bucket_num_)
+};
+
+/**
+ * @brief 	 [简介] 按键排序, 同时对负载做相同的置换, 稳定排序
+ * @param 	 keys [in/out], num 个 32/64 位无符号键
+ * @param 	 values [in/out], num 个负载, 与键一起移动; 相同键的负载保持原有顺序
+ * @param 	 num [in], 元素个数
+ * @param 	 key_bits [in], 键的有效位数, 只排序低 key_bits 位, 如 Morton 编码为 DIM * depth
+ * @param 	 threads [in], 并行的段数, 0 为共享线程池的线程数; 元素较少时自动减少
+ * @note 	 [注意] 在 ThreadPool::shared() 上执行
+ */
+template <typename Key, typename Value>
+void radix_sort(Key *keys, Value *values, size_t num, size_t key_bits = sizeof(Key) * 8, size_t threads = 0)
+{
+    RadixSorter<Key, Value>(keys, values, num, key_bits, threads, ThreadPool::shared()).run();
+}
+
+/**
+ * @brief 	 [简介] 只对键排序
+ */
+template <typename Key>
+void radix_sort(Key *keys, size_t num, size_t key_bits = sizeof(Key) * 8, size_t threads = 0)
+{
+    RadixSorter<Key, uint8_t>(keys, nullptr, num, key_bits, threads, ThreadPool::shared()).run();
+}
+
+#endif // __RADIX_SORT_H__
@@ -0,0 +1,236 @@
+#ifndef __SIMD_H__
+#define __SIMD_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief 	 [简介] 轴对齐盒子的几何判断, 标量实现, 适用于任意维度和标量类型
+ * @note 	 [注意] 所有指针指向 DIM 个连续的标量; 比较的规则与 NaN 的处理方式和向量实现完全相同
+ */
+template <typename T, size_t DIM>
+struct ScalarBoxKernel
+{
+    /**
+     * @brief 	 [简介] 子区域 id, 第 i 位表示 pos[i] > center[i]
+     */
+    static size_t find_index(const T *pos, const T *center)
+    {
+        size_t index = 0;
+        for (size_t i = 0; i < DIM; ++i) {
+            if (pos[i] > center[i]) index |= (1 << i);
+        }
+        return index;
+    }
+
+    /**
+     * @brief 	 [简介] 点是否在闭区间盒子 [min, max] 内
+     */
+    static bool is_in(const T *pos, const T *min, const T *max)
+    {
+        for (size_t i = 0; i < DIM; ++i) {
+            if (pos[i] < min[i] || pos[i] > max[i]) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 	 [简介] 以 center 为中心, half 为半尺寸的盒子是否与 [lo, hi] 相交(边界接触也算相交)
+     */
+    static bool overlap(const T *center, const T *half, const T *lo, const T *hi)
+    {
+        for (size_t i = 0; i < DIM; ++i) {
+            if (center[i] - half[i] > hi[i] || center[i] + half[i] < lo[i]) return false;
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief 	 [简介] 盒子几何判断, 对 float/double 的 2/3 维使用 SSE(有 __AVX__ 时 3 维 double 使用 AVX), 其余为标量实现
+ * @note 	 [注意] 3 维只读取 3 个分量, 不会越界访问第 4 个分量
+ */
+template <typename T, size_t DIM>
+struct BoxKernel : ScalarBoxKernel<T, DIM> { };
+
+#if defined(__SSE2__)
+template <>
+struct BoxKernel<double, 2>
+{
+    static __m128d load(const double *p) { return _mm_loadu_pd(p); }
+
+    static size_t find_index(const double *pos, const double *center)
+    {
+        return size_t(_mm_movemask_pd(_mm_cmpgt_pd(load(pos), load(center))));
+    }
+
+    static bool is_in(const double *pos, const double *min, const double *max)
+    {
+        __m128d p = load(pos);
+        return _mm_movemask_pd(_mm_or_pd(_mm_cmplt_pd(p, load(min)), _mm_cmpgt_pd(p, load(max)))) == 0;
+    }
+
+    static bool overlap(const double *center, const double *half, const double *lo, const double *hi)
+    {
+        __m128d c = load(center), h = load(half);
+        __m128d out = _mm_or_pd(_mm_cmpgt_pd(_mm_sub_pd(c, h), load(hi)), _mm_cmplt_pd(_mm_add_pd(c, h), load(lo)));
+        return _mm_movemask_pd(out) == 0;
+    }
+};
+
+#if defined(__AVX__)
+template <>
+struct BoxKernel<double, 3>
+{
+    static __m256d load(const double *p) { return _mm256_maskload_pd(p, _mm256_set_epi64x(0, -1, -1, -1)); }
+
+    static size_t find_index(const double *pos, const double *center)
+    {
+        return size_t(_mm256_movemask_pd(_mm256_cmp_pd(load(pos), load(center), _CMP_GT_OQ)) & 7);
+    }
+
+    static bool is_in(const double *pos, const double *min, const double *max)
+    {
+        __m256d p = load(pos);
+        __m256d out = _mm256_or_pd(_mm256_cmp_pd(p, load(min), _CMP_LT_OQ), _mm256_cmp_pd(p, load(max), _CMP_GT_OQ));
+        return (_mm256_movemask_pd(out) & 7) == 0;
+    }
+
+    static bool overlap(const double *center, const double *half, const double *lo, const double *hi)
+    {
+        __m256d c = load(center), h = load(half);
+        __m256d out = _mm256_or_pd(_mm256_cmp_pd(_mm256_sub_pd(c, h), load(hi), _CMP_GT_OQ),
+                                   _mm256_cmp_pd(_mm256_add_pd(c, h), load(lo), _CMP_LT_OQ));
+        return (_mm256_movemask_pd(out) & 7) == 0;
+    }
+};
+#else
+template <>
+struct BoxKernel<double, 3>
+{
+    // 前两个分量用一个寄存器, 第三个分量用标量指令
+    static size_t find_index(const double *pos, const double *center)
+    {
+        int mask = _mm_movemask_pd(_mm_cmpgt_pd(_mm_loadu_pd(pos), _mm_loadu_pd(center)));
+        mask |= (_mm_movemask_pd(_mm_cmpgt_sd(_mm_load_sd(pos + 2), _mm_load_sd(center + 2))) & 1) << 2;
+        return size_t(mask);
+    }
+
+    static bool is_in(const double *pos, const double *min, const double *max)
+    {
+        __m128d p = _mm_loadu_pd(pos), z = _mm_load_sd(pos + 2);
+        __m128d out = _mm_or_pd(_mm_cmplt_pd(p, _mm_loadu_pd(min)), _mm_cmpgt_pd(p, _mm_loadu_pd(max)));
+        __m128d out_z = _mm_or_pd(_mm_cmplt_sd(z, _mm_load_sd(min + 2)), _mm_cmpgt_sd(z, _mm_load_sd(max + 2)));
+        return (_mm_movemask_pd(out) | (_mm_movemask_pd(out_z) & 1)) == 0;
+    }
+
+    static bool overlap(const double *center, const double *half, const double *lo, const double *hi)
+    {
+        return BoxKernel<double, 2>::overlap(center, half, lo, hi) &&
+               !(center[2] - half[2] > hi[2] || center[2] + half[2] < lo[2]);
+    }
+};
+#endif
+
+/**
+ * @brief 	 [简介] float 的 2/3 维共用一个 128 位寄存器, 多余的分量填 0 并在掩码中去掉
+ */
+template <size_t DIM>
+struct FloatBoxKernel
+{
+    static_assert(DIM == 2 || DIM == 3, "only 2/3 dims");
+    constexpr static int lanes_ = (1 << DIM) - 1;
+
+    static __m128 load(const float *p)
+    {
+        // movq 读取 8 字节, 不要求对齐
+        __m128 xy = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+        return DIM == 2 ? xy : _mm_movelh_ps(xy, _mm_load_ss(p + 2));
+    }
+
+    static size_t find_index(const float *pos, const float *center)
+    {
+        return size_t(_mm_movemask_ps(_mm_cmpgt_ps(load(pos), load(center))) & lanes_);
+    }
+
+    static bool is_in(const float *pos, const float *min, const float *max)
+    {
+        __m128 p = load(pos);
+        return (_mm_movemask_ps(_mm_or_ps(_mm_cmplt_ps(p, load(min)), _mm_cmpgt_ps(p, load(max)))) & lanes_) == 0;
+    }
+
+    static bool overlap(const float *center, const float *half, const float *lo, const float *hi)
+    {
+        __m128 c = load(center), h = load(half);
+        __m128 out = _mm_or_ps(_mm_cmpgt_ps(_mm_sub_ps(c, h), load(hi)), _mm_cmplt_ps(_mm_add_ps(c, h), load(lo)));
+        return (_mm_movemask_ps(out) & lanes_) == 0;
+    }
+};
+
+template <> struct BoxKernel<float, 2> : FloatBoxKernel<2> { };
+template <> struct BoxKernel<float, 3> : FloatBoxKernel<3> { };
+#endif // __SSE2__
+
+/**
+ * @brief 	 [简介] 向量类型 V 的前 DIM 个分量是否为连续存放的 float/double, 如 Eigen::Vector3d, Eigen::Vector4f, std::array
+ */
+template <typename V, size_t DIM>
+struct is_packed_vector
+{
+    using Scalar = typename std::decay<decltype(std::declval<V&>()[0])>::type;
+    constexpr static bool value = (std::is_same<Scalar, float>::value || std::is_same<Scalar, double>::value) &&
+                                  sizeof(V) % sizeof(Scalar) == 0 && sizeof(V) >= DIM * sizeof(Scalar) &&
+                                  sizeof(V) <= 4 * sizeof(Scalar) && std::is_lvalue_reference<decltype(std::declval<V&>()[0])>::value;
+};
+
+/**
+ * @brief 	 [简介] 以向量类型为参数的盒子几何判断, 连续存放的向量交给 BoxKernel, 其余类型逐分量比较
+ */
+template <typename V, size_t DIM, bool Packed = is_packed_vector<V, DIM>::value>
+struct VecKernel
+{
+    static size_t find_index(const V& pos, const V& center)
+    {
+        size_t index = 0;
+        for (size_t i = 0; i < DIM; ++i) {
+            if (pos[i] > center[i]) index |= (1 << i);
+        }
+        return index;
+    }
+
+    static bool is_in(const V& pos, const V& min, const V& max)
+    {
+        for (size_t i = 0; i < DIM; ++i) {
+            if (pos[i] < min[i] || pos[i] > max[i]) return false;
+        }
+        return true;
+    }
+
+    static bool overlap(const V& center, const V& half, const V& lo, const V& hi)
+    {
+        for (size_t i = 0; i < DIM; ++i) {
+            if (center[i] - half[i] > hi[i] || center[i] + half[i] < lo[i]) return false;
+        }
+        return true;
+    }
+};
+
+template <typename V, size_t DIM>
+struct VecKernel<V, DIM, true>
+{
+    using Kernel = BoxKernel<typename is_packed_vector<V, DIM>::Scalar, DIM>;
+
+    static size_t find_index(const V& pos, const V& center) { return Kernel::find_index(&pos[0], &center[0]); }
+    static bool is_in(const V& pos, const V& min, const V& max) { return Kernel::is_in(&pos[0], &min[0], &max[0]); }
+    static bool overlap(const V& center, const V& half, const V& lo, const V& hi)
+    {
+        return Kernel::overlap(&center[0], &half[0], &lo[0], &hi[0]);
+    }
+};
+
+#endif // __SIMD_H__
@@ -0,0 +1,289 @@
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 	 [简介] 工作窃取线程池, 每个工作线程有自己的任务队列
+ * @note 	 [注意] 工作线程提交的任务放入自己队列的尾部, 并从尾部取任务(后进先出, 递归分解时缓存更热);
+ *                  自己的队列为空时从其他队列的头部窃取(先进先出, 窃取到的是较大的任务);
+ *                  非工作线程提交的任务放入一个公共队列, 同样可以被窃取; 没有任务时工作线程休眠
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief 	 [简介] 构造函数, 启动工作线程
+     * @param 	 threads [in], 工作线程数, 0 为硬件线程数; 调用 TaskGroup::sync 的线程也会参与执行
+     */
+    explicit ThreadPool(size_t threads = 0) : queued_(0), stop_(false)
+    {
+        if (threads == 0) threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        for (size_t i = 0; i <= threads; ++i) queues_.emplace_back(new Queue());
+        for (size_t i = 0; i < threads; ++i) workers_.emplace_back(&ThreadPool::work, this, i);
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cond_.notify_all();
+        for (auto &worker : workers_) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief 	 [简介] 全局共享的线程池, 第一次调用时创建
+     * @note 	 [注意] 线程数由 set_shared_threads 决定, 需要在第一次调用之前设置
+     */
+    static ThreadPool& shared()
+    {
+        static ThreadPool pool(shared_threads());
+        return pool;
+    }
+
+    /**
+     * @brief 	 [简介] 设置共享线程池的工作线程数, 0 为硬件线程数, 在共享线程池创建之后调用无效
+     */
+    static void set_shared_threads(size_t threads) { shared_threads() = threads; }
+
+    /**
+     * @brief 	 [简介] 工作线程数
+     */
+    size_t size() const { return workers_.size(); }
+
+    /**
+     * @brief 	 [简介] 提交一个任务, 不等待完成; 需要等待时使用 TaskGroup
+     * @param 	 task [in], 任务
+     */
+    void submit(Task task)
+    {
+        Queue& queue = *queues_[local_index()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        queued_.fetch_add(1, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+        }
+        cond_.notify_one();
+    }
+
+    /**
+     * @brief 	 [简介] 在当前线程执行一个任务: 先取自己的队列, 再从其他队列窃取
+     * @return 	 [true] 执行了一个任务 or [false] 所有队列都为空
+     */
+    bool run_one()
+    {
+        Task task;
+        if (!take(local_index(), task)) return false;
+        task();
+        return true;
+    }
+
+    /**
+     * @brief 	 [简介] 并行循环, 区间对半递归拆分, 拆出的右半部分可以被其他线程窃取
+     * @param 	 begin [in], 起点
+     * @param 	 end [in], 终点(不含)
+     * @param 	 grain [in], 不再拆分的最大长度, 0 时按线程数自动选择
+     * @param 	 func [in], 处理一段子区间, 参数为 (lo, hi)
+     */
+    template <typename Func>
+    void parallel_for(size_t begin, size_t end, size_t grain, const Func& func);
+
+    /**
+     * @brief 	 [简介] 并行归约, 拆分方式与 parallel_for 相同, 总是按 (左, 右) 的顺序合并, 结果与线程数无关
+     * @param 	 begin [in], 起点
+     * @param 	 end [in], 终点(不含)
+     * @param 	 grain [in], 不再拆分的最大长度, 0 时按线程数自动选择
+     * @param 	 identity [in], 空区间的结果
+     * @param 	 map [in], 计算一段子区间的结果, 参数为 (lo, hi)
+     * @param 	 reduce [in], 合并两个相邻子区间的结果
+     * @return 	 [T] 返回整个区间的结果
+     */
+    template <typename T, typename Map, typename Reduce>
+    T parallel_reduce(size_t begin, size_t end, size_t grain, T identity, const Map& map, const Reduce& reduce);
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    static size_t& shared_threads()
+    {
+        static size_t threads = 0;
+        return threads;
+    }
+
+    /**
+     * @brief 	 [简介] 当前线程所属线程池, 以及在该线程池中的队列下标
+     */
+    struct Worker
+    {
+        const ThreadPool *pool;
+        size_t index;
+    };
+
+    static Worker& current()
+    {
+        static thread_local Worker worker{nullptr, 0};
+        return worker;
+    }
+
+    /**
+     * @brief 	 [简介] 当前线程使用的队列: 本线程池的工作线程用自己的队列, 其他线程用公共队列(最后一个)
+     */
+    size_t local_index() const
+    {
+        const Worker& worker = current();
+        return worker.pool == this ? worker.index : workers_.size();
+    }
+
+    /**
+     * @brief 	 [简介] 取一个任务: 自己的队列取尾部, 其他队列取头部
+     */
+    bool take(size_t self, Task& task)
+    {
+        if (queued_.load(std::memory_order_acquire) <= 0) return false;
+        size_t num = queues_.size();
+        for (size_t k = 0; k < num; ++k) {
+            size_t i = (self + k) % num;
+            Queue& queue = *queues_[i];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) continue;
+            if (k == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void work(size_t index)
+    {
+        current() = Worker{this, index};
+        Task task;
+        while (true) {
+            if (take(index, task)) {
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this]() { return stop_ || queued_.load(std::memory_order_acquire) > 0; });
+            if (stop_) return;
+        }
+    }
+private:
+    std::vector<std::unique_ptr<Queue>> queues_;    // 第 i 个为第 i 个工作线程的队列, 最后一个为公共队列
+    std::vector<std::thread> workers_;
+    std::atomic<long> queued_;                      // 所有队列中的任务数, 入队和计数不是原子的, 可能短暂为负; 不大于 0 时工作线程休眠
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool stop_;
+};
+
+/**
+ * @brief 	 [简介] 一组任务的 fork-join: spawn 提交任务, sync 等待本组的任务全部完成
+ * @note 	 [注意] sync 在等待期间执行线程池中的任务(包括其他组的), 所以在任务中递归 spawn/sync 不会死锁;
+ *                  析构时自动 sync
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::shared()) : pool_(pool), pending_(0) { }
+    ~TaskGroup() { sync(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /**
+     * @brief 	 [简介] 提交一个任务, 任务引用的对象需要在 sync 之前保持有效
+     * @param 	 func [in], 任务
+     */
+    template <typename Func>
+    void spawn(Func func)
+    {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        pool_.submit([this, func]() {
+            func();
+            pending_.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    /**
+     * @brief 	 [简介] 等待本组的任务全部完成
+     */
+    void sync()
+    {
+        while (pending_.load(std::memory_order_acquire) != 0) {
+            if (!pool_.run_one()) std::this_thread::yield();
+        }
+    }
+
+    ThreadPool& pool() { return pool_; }
+private:
+    ThreadPool& pool_;
+    std::atomic<size_t> pending_;
+};
+
+template <typename Func>
+void ThreadPool::parallel_for(size_t begin, size_t end, size_t grain, const Func& func)
+{
+    if (begin >= end) return;
+    if (grain == 0) grain = std::max<size_t>((end - begin) / (4 * (size() + 1)), 1);
+
+    TaskGroup group(*this);
+    std::function<void(size_t, size_t)> split = [&](size_t lo, size_t hi) {
+        while (hi - lo > grain) {
+            size_t mid = lo + (hi - lo) / 2;
+            group.spawn([&split, mid, hi]() { split(mid, hi); });
+            hi = mid;
+        }
+        func(lo, hi);
+    };
+    split(begin, end);
+    group.sync();
+}
+
+template <typename T, typename Map, typename Reduce>
+T ThreadPool::parallel_reduce(size_t begin, size_t end, size_t grain, T identity, const Map& map, const Reduce& reduce)
+{
+    if (begin >= end) return identity;
+    if (grain == 0) grain = std::max<size_t>((end - begin) / (4 * (size() + 1)), 1);
+
+    std::function<T(size_t, size_t)> split = [&](size_t lo, size_t hi) -> T {
+        if (hi - lo <= grain) return map(lo, hi);
+        size_t mid = lo + (hi - lo) / 2;
+        T right = identity;
+        TaskGroup group(*this);
+        group.spawn([&split, &right, mid, hi]() { right = split(mid, hi); });
+        T left = split(lo, mid);
+        group.sync();
+        return reduce(left, right);
+    };
+    return split(begin, end);
+}
+
+#endif // __THREAD_POOL_H__
@@ -0,0 +1,277 @@
+/**
+ * Copyright (C), 2023
+ * @file 	 chunked_world.h
+ * @author 	 peitianyu(https://github.com/peitianyu)
+ * @date 	 2026-10-17
+ * @brief 	 [简介] 由许多固定大小的 Octree 分块组成的超大地图, 按 LRU 在内存和磁盘之间换入换出
+ */
+#ifndef __CHUNKED_WORLD_H__
+#define __CHUNKED_WORLD_H__
+
+#include <array>
+#include <cerrno>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <sys/stat.h>
+#include "octree/octree.h"
+
+/**
+ * @brief 	 [简介] 分块世界地图
+ * @note 	 [注意] 空间按 chunk_size 切成规则网格, 每个格子是一棵独立的 Octree;
+ *                  内存中分块的总占用超过预算时, 把最久未访问的分块写回磁盘并释放;
+ *                  insert/find/query_box 会按需从磁盘加载分块, 对调用者透明
+ */
+template <typename PosType, typename DataType, size_t DIM>
+class ChunkedWorld {
+public:
+    using Tree = Octree<PosType, DataType, DIM>;
+    using Node = typename Tree::Node;
+    using ChunkKey = std::array<int64_t, DIM>;
+
+    /**
+     * @brief 	 [简介] 构造函数
+     * @param 	 chunk_size [in], 分块尺寸
+     * @param 	 chunk_depth [in], 每个分块的最大深度
+     * @param 	 dir [in], 分块文件所在目录, 不存在时会创建
+     * @param 	 memory_budget [in], 内存预算(字节)
+     */
+    ChunkedWorld(const PosType& chunk_size, size_t chunk_depth, const std::string& dir, size_t memory_budget)
+        : chunk_size_(chunk_size), chunk_depth_(chunk_depth), dir_(dir), memory_budget_(memory_budget), memory_(0)
+    {
+        mkdir(dir_.c_str(), 0755);
+    }
+
+    /**
+     * @brief 	 [简介] 析构函数, 把修改过的分块写回磁盘
+     */
+    ~ChunkedWorld() { flush(); }
+
+    ChunkedWorld(const ChunkedWorld&) = delete;
+    ChunkedWorld& operator=(const ChunkedWorld&) = delete;
+
+    /**
+     * @brief 	 [简介] 插入点, 所在分块不存在时新建
+     * @param 	 pos [in], 点位置
+     * @param 	 data [in], 所带数据
+     * @return 	 [true] 成功 or [false] 分块文件存在但加载失败, 点未插入, 磁盘上的分块不会被覆盖
+     */
+    bool insert(const PosType& pos, const DataType& data)
+    {
+        Chunk *chunk = load(chunk_key(pos), true);
+        if (chunk == nullptr) return false;
+        size_t before = chunk->tree->memory_usage();
+        chunk->tree->insert(pos, data);
+        chunk->dirty = true;
+        memory_ += chunk->tree->memory_usage() - before;
+        evict();
+        return true;
+    }
+
+    /**
+     * @brief 	 [简介] 用于查找点
+     * @param 	 pos [in], 点位置
+     * @return 	 [Node*], 返回节点指针, 所在分块不存在或加载失败时返回 nullptr; 分块被换出后指针失效
+     */
+    Node *find(const PosType& pos) { return find(pos, chunk_depth_); }
+
+    Node *find(const PosType& pos, const size_t& depth)
+    {
+        Chunk *chunk = load(chunk_key(pos), false);
+        return chunk == nullptr ? nullptr : chunk->tree->find(pos, depth);
+    }
+
+    /**
+     * @brief 	 [简介] 范围查询, 依次访问与查询框相交的每个分块
+     * @param 	 min [in], 查询框最小值
+     * @param 	 max [in], 查询框最大值
+     * @param 	 func [in], 访问函数, 节点指针只在回调中有效
+     * @param 	 depth [in], 查询深度, 默认为分块的最大深度
+     */
+    void query_box(const PosType& min, const PosType& max, std::function<void(Node* node)> func)
+    {
+        query_box(min, max, func, chunk_depth_);
+    }
+
+    void query_box(const PosType& min, const PosType& max, std::function<void(Node* node)> func, size_t depth)
+    {
+        ChunkKey lo = chunk_key(min), hi = chunk_key(max), key = lo;
+        while (true) {
+            Chunk *chunk = load(key, false);
+            if (chunk != nullptr) chunk->tree->query_box(min, max, func, depth);
+
+            size_t i = 0;
+            for (; i < DIM; ++i) {
+                if (++key[i] <= hi[i]) break;
+                key[i] = lo[i];
+            }
+            if (i == DIM) break;
+        }
+    }
+
+    /**
+     * @brief 	 [简介] 沿预测路径预取分块
+     * @param 	 path [in], 预测路径, 越靠前越先被用到
+     * @note 	 [注意] 倒序加载, 使路径起点附近的分块最后被换出
+     */
+    void prefetch(const std::vector<PosType>& path)
+    {
+        for (auto it = path.rbegin(); it != path.rend(); ++it) load(chunk_key(*it), false);
+    }
+
+    /**
+     * @brief 	 [简介] 把所有修改过的分块写回磁盘, 分块仍保留在内存中
+     * @return 	 [true] 全部写回 or [false] 有分块写回失败, 这些分块保持修改状态
+     */
+    bool flush()
+    {
+        bool ok = true;
+        for (auto &chunk : chunks_) {
+            if (!chunk.second.dirty) continue;
+            if (save(chunk.first, *chunk.second.tree)) chunk.second.dirty = false;
+            else ok = false;
+        }
+        return ok;
+    }
+
+    /**
+     * @brief 	 [简介] 内存中的分块数量
+     */
+    size_t loaded_chunks() const { return chunks_.size(); }
+
+    /**
+     * @brief 	 [简介] 内存中分块的总占用(字节)
+     */
+    size_t memory_usage() const { return memory_; }
+
+    /**
+     * @brief 	 [简介] 计算点所在分块的坐标
+     */
+    ChunkKey chunk_key(const PosType& pos) const
+    {
+        ChunkKey key;
+        for (size_t i = 0; i < DIM; ++i) key[i] = int64_t(std::floor(pos[i] / chunk_size_[i]));
+        return key;
+    }
+private:
+    struct Chunk
+    {
+        std::unique_ptr<Tree> tree;
+        typename std::list<ChunkKey>::iterator lru;
+        bool dirty;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const ChunkKey& key) const
+        {
+            size_t hash = 0;
+            for (size_t i = 0; i < DIM; ++i) hash = hash * 1000003u ^ std::hash<int64_t>()(key[i]);
+            return hash;
+        }
+    };
+
+    /**
+     * @brief 	 [简介] 获取分块, 不在内存中时从磁盘加载
+     * @param 	 key [in], 分块坐标
+     * @param 	 create [in], 磁盘上也不存在时是否新建
+     * @return 	 [Chunk*] 返回分块, 不存在且不新建时返回 nullptr;
+     *                    分块文件存在但无法读取或格式错误时也返回 nullptr, 不新建, 下次访问时重试
+     * @note 	 [注意] 只有文件确实不存在时才新建空分块并标记为修改, 损坏的文件不会被空分块覆盖
+     */
+    Chunk *load(const ChunkKey& key, bool create)
+    {
+        auto it = chunks_.find(key);
+        if (it != chunks_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            return &it->second;
+        }
+        if (!create && absent_.count(key)) return nullptr;
+
+        std::string path = chunk_path(key);
+        struct stat st;
+        bool exists = stat(path.c_str(), &st) == 0 || (errno != ENOENT && errno != ENOTDIR);
+        std::unique_ptr<Tree> tree = make_tree(key);
+        if (exists) {
+            std::ifstream ifs(path, std::ios::binary);
+            if (!ifs.is_open() || !tree->load(ifs)) return nullptr;
+        } else if (!create) {
+            // 不存在的分块只是查询的缓存, 超过上限时整体清空
+            if (absent_.size() >= absent_limit_) absent_.clear();
+            absent_.insert(key);
+            return nullptr;
+        }
+        absent_.erase(key);
+
+        lru_.push_front(key);
+        Chunk &chunk = chunks_[key];
+        chunk.tree = std::move(tree);
+        chunk.lru = lru_.begin();
+        chunk.dirty = !exists;
+        memory_ += chunk.tree->memory_usage();
+        evict();
+        return &chunk;
+    }
+
+    /**
+     * @brief 	 [简介] 换出最久未访问的分块直到满足内存预算, 最近访问的分块始终保留
+     * @note 	 [注意] 写回失败的分块留在内存中, 不丢弃修改, 此时内存占用可能超过预算
+     */
+    void evict()
+    {
+        if (lru_.empty()) return;
+        auto lru = std::prev(lru_.end());
+        while (memory_ > memory_budget_ && lru != lru_.begin()) {
+            auto it = chunks_.find(*lru);
+            if (it->second.dirty && !save(it->first, *it->second.tree)) {
+                --lru;
+                continue;
+            }
+            memory_ -= it->second.tree->memory_usage();
+            chunks_.erase(it);
+            lru = std::prev(lru_.erase(lru));
+        }
+    }
+
+    bool save(const ChunkKey& key, const Tree& tree) const
+    {
+        std::ofstream ofs(chunk_path(key), std::ios::binary | std::ios::trunc);
+        return ofs.is_open() && tree.save(ofs);
+    }
+
+    std::unique_ptr<Tree> make_tree(const ChunkKey& key) const
+    {
+        PosType min = chunk_size_, max = chunk_size_;
+        for (size_t i = 0; i < DIM; ++i) {
+            min[i] = chunk_size_[i] * key[i];
+            max[i] = chunk_size_[i] * (key[i] + 1);
+        }
+        return std::unique_ptr<Tree>(new Tree(min, max, chunk_depth_));
+    }
+
+    std::string chunk_path(const ChunkKey& key) const
+    {
+        std::string path = dir_ + "/chunk";
+        for (size_t i = 0; i < DIM; ++i) path += "_" + std::to_string(key[i]);
+        return path + ".oct";
+    }
+private:
+    PosType chunk_size_;
+    size_t chunk_depth_;
+    std::string dir_;
+    size_t memory_budget_;
+    size_t memory_;
+    std::list<ChunkKey> lru_;
+    std::unordered_map<ChunkKey, Chunk, KeyHash> chunks_;
+    std::unordered_set<ChunkKey, KeyHash> absent_;     // 已知磁盘上不存在的分块, 避免重复访问文件系统
+    constexpr static size_t absent_limit_ = 1 << 16;
+};
+
+#endif // __CHUNKED_WORLD_H__
@@ -0,0 +1,148 @@
+/**
+ * Copyright (C), 2023
+ * @file 	 linear_octree.h
+ * @author 	 peitianyu(https://github.com/peitianyu)
+ * @date 	 2026-10-17
+ * @brief 	 [简介] 线性化(无指针)的只读四叉树/八叉树, 用于发布给读线程查询
+ */
+#ifndef __LINEAR_OCTREE_H__
+#define __LINEAR_OCTREE_H__
+
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include "octree/octree.h"
+#include "octree/space_curve.h"
+
+/**
+ * @brief 	 [简介] 把 Octree 按深度优先(前序)展开到一段连续数组中
+ * @note 	 [注意] 子节点紧跟在父节点之后, 每个节点记录其子树的结束位置, 查找时只向前访问内存;
+ *                  兄弟节点之间的顺序由 Curve 决定, 查找按子区域id匹配, 与顺序无关
+ */
+template <typename PosType, typename DataType, size_t DIM>
+class LinearOctree {
+public:
+    using Tree = Octree<PosType, DataType, DIM>;
+    using Boundary = typename Tree::Boundary;
+    constexpr static size_t child_num_ = Tree::child_num_;
+
+    struct Node
+    {
+        PosType center;
+        DataType data;
+        uint32_t depth;
+        uint32_t index;     // 在父节点中的子区域id
+        uint32_t end;       // 子树结束位置(不含)
+    };
+
+    /**
+     * @brief 	 [简介] 构造函数, 从 Octree 生成线性副本
+     * @param 	 tree [in], 源树
+     * @param 	 curve [in], 兄弟节点的排列顺序, MORTON 为子区域id顺序, HILBERT 使空间上相邻的叶子在数组中也相邻
+     * @note 	 [注意] 源树可以使用任意的 RefPolicy 和内部坐标类型, 节点中心统一转换为 PosType
+     */
+    template <typename RefPolicy, typename Coord>
+    explicit LinearOctree(const Octree<PosType, DataType, DIM, RefPolicy, Coord>& tree, Curve curve = Curve::MORTON)
+        : boundary_(tree.boundary().min, tree.boundary().max), max_depth_(tree.max_depth()), curve_(curve)
+    {
+        for (size_t d = 0; d <= max_depth_; ++d) half_sizes_.push_back(tree.half_size(d));
+        flatten(tree, tree.root(), 0, 0);
+    }
+
+    /**
+     * @brief 	 [简介] 用于查找点
+     * @param 	 pos [in], 点位置
+     * @return 	 [const Node*], 返回节点指针
+     */
+    const Node *find(const PosType& pos) const { return find(pos, max_depth_); }
+
+    /**
+     * @brief 	 [简介] 用于查找点
+     * @param 	 pos [in], 点位置
+     * @param 	 depth [in], 查找深度
+     * @return 	 [const Node*], 返回节点指针, 与 Octree::find 相同, 返回路径上不超过 depth 的最深节点
+     */
+    const Node *find(const PosType& pos, const size_t& depth) const
+    {
+        size_t cur = 0;
+        while (nodes_[cur].depth < depth) {
+            size_t index = find_index(pos, nodes_[cur]);
+            size_t child = cur + 1;
+            while (child < nodes_[cur].end && nodes_[child].index != index) child = nodes_[child].end;
+            if (child >= nodes_[cur].end) break;
+            cur = child;
+        }
+        return &nodes_[cur];
+    }
+
+    /**
+     * @brief 	 [简介] 找到节点的边界
+     * @param 	 node [in], 需要找到边界的节点
+     * @param 	 boundary [in], 边界
+     */
+    void find_boundary(const Node* node, Boundary& boundary) const
+    {
+        const PosType& half_size = half_sizes_[node->depth];
+        boundary.min = node->center - half_size;
+        boundary.max = node->center + half_size;
+    }
+
+    /**
+     * @brief 	 [简介] 按存储顺序(前序)遍历所有节点
+     * @param 	 func [in], 可视化函数
+     */
+    void visual(std::function<void(const Node* node)> func) const
+    {
+        for (const Node& node : nodes_) func(&node);
+    }
+
+    /**
+     * @brief 	 [简介] 节点数量
+     */
+    size_t size() const { return nodes_.size(); }
+
+    const Boundary& boundary() const { return boundary_; }
+    size_t max_depth() const { return max_depth_; }
+    Curve curve() const { return curve_; }
+private:
+    /**
+     * @brief 	 [简介] 递归展开子树
+     * @param 	 tree [in], 源树
+     * @param 	 node [in], 源节点
+     * @param 	 index [in], 源节点在父节点中的子区域id
+     * @param 	 key [in], 源节点的 Morton 编码, 用于计算 Hilbert 序
+     */
+    template <typename SrcTree, typename SrcNode>
+    void flatten(const SrcTree& tree, const SrcNode *node, size_t index, uint64_t key)
+    {
+        size_t cur = nodes_.size();
+        nodes_.push_back(Node{tree.position(node), node->data, uint32_t(node->depth), uint32_t(index), 0});
+
+        size_t childs[child_num_];
+        for (size_t i = 0; i < child_num_; ++i) childs[i] = i;
+        size_t bottom = hilbert_bottom<DIM>(max_depth_);
+        if (curve_ == Curve::HILBERT && node->depth < bottom) hilbert_child_order<DIM>(key, node->depth, bottom, childs);
+        for (size_t k = 0; k < child_num_; ++k) {
+            size_t i = childs[k];
+            if (tree.child(node, i) != nullptr) flatten(tree, tree.child(node, i), i, (key << DIM) | i);
+        }
+        nodes_[cur].end = uint32_t(nodes_.size());
+    }
+
+    size_t find_index(const PosType& pos, const Node& node) const
+    {
+        size_t index = 0;
+        for (size_t i = 0; i < DIM; ++i) {
+            if (pos[i] > node.center[i]) index |= (1 << i);
+        }
+        return index;
+    }
+private:
+    Boundary boundary_;
+    size_t max_depth_;
+    Curve curve_;
+    AlignedVector<PosType> half_sizes_;   // 每层节点的半尺寸, 取自源树
+    AlignedVector<Node> nodes_;
+};
+
+#endif // __LINEAR_OCTREE_H__
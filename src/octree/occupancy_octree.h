@@ -0,0 +1,303 @@
+/**
+ * Copyright (C), 2023
+ * @file 	 occupancy_octree.h
+ * @author 	 peitianyu(https://github.com/peitianyu)
+ * @date 	 2026-10-17
+ * @brief 	 [简介] 只记录占据/空闲的四叉树/八叉树, 每个子区域用 2 位表示, 节点不存中心、深度和数据
+ */
+#ifndef __OCCUPANCY_OCTREE_H__
+#define __OCCUPANCY_OCTREE_H__
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "octree/octree.h"
+
+/**
+ * @brief 	 [简介] 占据树, 相当于 DataType 为 bool 的 Octree
+ * @note 	 [注意] 每个节点只有一个掩码(每个子区域 2 位: 空闲/全部占据/混合)和子节点块的下标, 共 8 字节;
+ *                  只有混合的子区域才有节点, 同一个节点的子节点分配在一个连续的块中;
+ *                  子区域全部占据或全部空闲时自动合并, 子树测试只需比较一个掩码
+ */
+template <typename PosType, size_t DIM>
+class OccupancyOctree {
+    static_assert(DIM <= 4, "mask holds at most 16 children");
+public:
+    constexpr static size_t child_num_ = 1 << DIM;
+    using Boundary = typename Octree<PosType, bool, DIM>::Boundary;
+
+    enum class Cell : uint8_t { FREE = 0, FULL = 1, MIXED = 2 };
+
+    /**
+     * @brief 	 [简介] 查询结果, 按值返回
+     */
+    struct Node
+    {
+        PosType center;
+        bool data;          // 区域内是否有占据
+        size_t depth;
+        Cell cell;
+    };
+
+    /**
+     * @brief 	 [简介] 构造函数
+     * @param 	 min [in], 边界最小值
+     * @param 	 max [in], 边界最大值
+     * @param 	 depth [in], 最大深度, 与 Octree 相同, 叶子在第 depth - 1 层, 超过 Octree 的 max_depth_limit_ 时截断
+     */
+    OccupancyOctree(const PosType& min, const PosType& max, size_t depth)
+        : boundary_(min, max), max_depth_(std::min(depth, size_t(Octree<PosType, bool, DIM>::max_depth_limit_))), live_(1)
+    {
+        half_sizes_.push_back(boundary_.size() / 2);
+        for (size_t d = 1; d <= max_depth_; ++d) half_sizes_.push_back(half_sizes_.back() / 2);
+        nodes_.push_back(Slot{0, npos_});
+    }
+
+    /**
+     * @brief 	 [简介] 标记点所在的叶子区域为占据或空闲
+     * @param 	 pos [in], 点位置
+     * @param 	 data [in], true 为占据, false 为空闲
+     */
+    void insert(const PosType& pos, bool data = true)
+    {
+        if (!boundary_.is_in(pos) || max_depth_ < 2) return;
+        insert(0, 0, boundary_.center(), boundary_.size() / 4, pos, data ? Cell::FULL : Cell::FREE);
+    }
+
+    /**
+     * @brief 	 [简介] 用于查找点
+     * @param 	 pos [in], 点位置
+     * @return 	 [Node] 返回点所在的最深节点(状态一致的区域或叶子)
+     */
+    Node find(const PosType& pos) const { return find(pos, max_depth_); }
+
+    /**
+     * @brief 	 [简介] 用于查找点
+     * @param 	 pos [in], 点位置
+     * @param 	 depth [in], 查找深度
+     * @return 	 [Node] 返回路径上不超过 depth 的最深节点
+     */
+    Node find(const PosType& pos, size_t depth) const
+    {
+        uint32_t node = 0;
+        Node result{boundary_.center(), false, 0, summarize(nodes_[0].mask)};
+        PosType half_size = boundary_.size() / 4;
+        while (result.depth < depth && result.cell == Cell::MIXED) {
+            size_t index = find_index(pos, result.center);
+            result.cell = get(nodes_[node].mask, index);
+            result.center = child_center(result.center, half_size, index);
+            ++result.depth;
+            half_size /= 2;
+            if (result.cell == Cell::MIXED) node = nodes_[node].childs + uint32_t(index);
+        }
+        result.data = result.cell != Cell::FREE;
+        return result;
+    }
+
+    /**
+     * @brief 	 [简介] 点所在的叶子区域是否被占据
+     */
+    bool is_occupied(const PosType& pos) const { return find(pos).data; }
+
+    /**
+     * @brief 	 [简介] 查询框内是否有占据区域, 遇到全部占据的区域立即返回, 全部空闲的区域直接跳过
+     * @param 	 min [in], 查询框最小值
+     * @param 	 max [in], 查询框最大值
+     * @return 	 [true] or [false]
+     */
+    bool box_occupied(const PosType& min, const PosType& max) const
+    {
+        bool found = false;
+        visit(0, 0, boundary_.center(), boundary_.size() / 4, Boundary(min, max), [&found](const Node&) {
+            found = true;
+            return false;
+        });
+        return found;
+    }
+
+    /**
+     * @brief 	 [简介] 范围查询, 访问与查询框相交的全部占据区域(合并后的区域可能大于叶子)
+     * @param 	 min [in], 查询框最小值
+     * @param 	 max [in], 查询框最大值
+     * @param 	 func [in], 访问函数
+     */
+    void query_box(const PosType& min, const PosType& max, std::function<void(const Node& node)> func) const
+    {
+        visit(0, 0, boundary_.center(), boundary_.size() / 4, Boundary(min, max), [&func](const Node& node) {
+            func(node);
+            return true;
+        });
+    }
+
+    /**
+     * @brief 	 [简介] 找到节点的边界
+     */
+    void find_boundary(const Node& node, Boundary& boundary) const
+    {
+        const PosType& half_size = half_sizes_[node.depth];
+        boundary.min = node.center - half_size;
+        boundary.max = node.center + half_size;
+    }
+
+    /**
+     * @brief 	 [简介] 节点数量(混合区域的数量, 包括根节点)
+     */
+    size_t size() const { return live_; }
+
+    /**
+     * @brief 	 [简介] 占用内存(字节), 包括空闲的子节点块
+     */
+    size_t memory_usage() const
+    {
+        return sizeof(*this) + nodes_.capacity() * sizeof(Slot) + free_.capacity() * sizeof(uint32_t);
+    }
+
+    const Boundary& boundary() const { return boundary_; }
+    size_t max_depth() const { return max_depth_; }
+private:
+    using Mask = uint32_t;
+
+    struct Slot
+    {
+        Mask mask;          // 第 i 个子区域的状态在第 2i, 2i+1 位
+        uint32_t childs;    // 子节点块的起始下标, 只有混合的子区域对应的位置有效
+    };
+
+    constexpr static uint32_t npos_ = 0xffffffffu;
+
+    // 所有子区域都全部占据 / 都是混合时的掩码
+    constexpr static Mask full_mask_ = Mask(0x55555555u >> (32 - 2 * child_num_));
+    constexpr static Mask mixed_mask_ = Mask(0xaaaaaaaau >> (32 - 2 * child_num_));
+
+    static Cell get(Mask mask, size_t index) { return Cell((mask >> (2 * index)) & 3); }
+
+    static Mask set(Mask mask, size_t index, Cell cell)
+    {
+        return (mask & ~(Mask(3) << (2 * index))) | (Mask(cell) << (2 * index));
+    }
+
+    /**
+     * @brief 	 [简介] 由子区域的状态得到区域本身的状态, 只需比较整个掩码
+     */
+    static Cell summarize(Mask mask)
+    {
+        if (mask == 0) return Cell::FREE;
+        if (mask == full_mask_) return Cell::FULL;
+        return Cell::MIXED;
+    }
+
+    /**
+     * @brief 	 [简介] 递归设置叶子区域的状态
+     * @param 	 node [in], 当前节点下标
+     * @param 	 depth [in], 当前节点深度
+     * @param 	 center [in], 当前节点中心
+     * @param 	 half_size [in], 子区域的半尺寸
+     * @param 	 pos [in], 点位置
+     * @param 	 value [in], 叶子区域的新状态
+     * @return 	 [Cell] 返回当前节点修改后的状态
+     * @note 	 [注意] nodes_ 可能在递归中扩容, 只能持有下标
+     */
+    Cell insert(uint32_t node, size_t depth, const PosType& center, const PosType& half_size, const PosType& pos, Cell value)
+    {
+        size_t index = find_index(pos, center);
+        Cell cell = get(nodes_[node].mask, index);
+        if (depth + 2 >= max_depth_ || cell == value) {
+            nodes_[node].mask = set(nodes_[node].mask, index, value);
+            return summarize(nodes_[node].mask);
+        }
+
+        // 统一状态的子区域展开成子节点, 子节点的子区域都继承原状态
+        if (cell != Cell::MIXED) {
+            if (nodes_[node].childs == npos_) {
+                uint32_t block = allocate();
+                nodes_[node].childs = block;
+            }
+            nodes_[nodes_[node].childs + index] = Slot{cell == Cell::FULL ? full_mask_ : 0, npos_};
+            ++live_;
+        }
+        uint32_t child = nodes_[node].childs + uint32_t(index);
+        Cell result = insert(child, depth + 1, child_center(center, half_size, index), half_size / 2, pos, value);
+
+        // 子节点变为统一状态后合并到本节点的掩码中
+        if (result != Cell::MIXED) --live_;
+        nodes_[node].mask = set(nodes_[node].mask, index, result);
+        if ((nodes_[node].mask & mixed_mask_) == 0 && nodes_[node].childs != npos_) {
+            free_.push_back(nodes_[node].childs);
+            nodes_[node].childs = npos_;
+        }
+        return summarize(nodes_[node].mask);
+    }
+
+    /**
+     * @brief 	 [简介] 分配一个子节点块, 优先复用空闲的块
+     */
+    uint32_t allocate()
+    {
+        if (!free_.empty()) {
+            uint32_t block = free_.back();
+            free_.pop_back();
+            return block;
+        }
+        uint32_t block = uint32_t(nodes_.size());
+        nodes_.resize(nodes_.size() + child_num_, Slot{0, npos_});
+        return block;
+    }
+
+    /**
+     * @brief 	 [简介] 递归访问与查询框相交的全部占据区域
+     * @param 	 func [in], 访问函数, 返回 false 时停止
+     * @return 	 [true] 继续 or [false] 已停止
+     */
+    template <typename Func>
+    bool visit(uint32_t node, size_t depth, const PosType& center, const PosType& half_size, const Boundary& box, const Func& func) const
+    {
+        Mask mask = nodes_[node].mask;
+        for (size_t i = 0; i < child_num_; ++i) {
+            Cell cell = get(mask, i);
+            if (cell == Cell::FREE) continue;
+            PosType child = child_center(center, half_size, i);
+            bool overlap = true;
+            for (size_t k = 0; k < DIM; ++k) {
+                if (child[k] - half_size[k] > box.max[k] || child[k] + half_size[k] < box.min[k]) overlap = false;
+            }
+            if (!overlap) continue;
+
+            if (cell == Cell::FULL) {
+                if (!func(Node{child, true, depth + 1, cell})) return false;
+            } else if (!visit(nodes_[node].childs + uint32_t(i), depth + 1, child, half_size / 2, box, func)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static size_t find_index(const PosType& pos, const PosType& center)
+    {
+        size_t index = 0;
+        for (size_t i = 0; i < DIM; ++i) {
+            if (pos[i] > center[i]) index |= (1 << i);
+        }
+        return index;
+    }
+
+    static PosType child_center(const PosType& center, const PosType& half_size, size_t index)
+    {
+        PosType child = center;
+        for (size_t i = 0; i < DIM; ++i) {
+            child[i] = (index & (1 << i)) ? center[i] + half_size[i] : center[i] - half_size[i];
+        }
+        return child;
+    }
+private:
+    Boundary boundary_;
+    size_t max_depth_;
+    size_t live_;
+    AlignedVector<PosType> half_sizes_;   // 每层节点的半尺寸, 与 Octree 相同逐层减半, 不做移位除法
+    std::vector<Slot> nodes_;       // 第 0 个为根节点, 其后为子节点块
+    std::vector<uint32_t> free_;    // 空闲的子节点块
+};
+
+template<typename PosType> using OccupancyQuadTree = OccupancyOctree<PosType, 2>;
+template<typename PosType> using OccupancyOctTree = OccupancyOctree<PosType, 3>;
+
+#endif // __OCCUPANCY_OCTREE_H__
@@ -10,34 +10,182 @@
 
 #include <vector>
 #include <functional>
+#include <type_traits>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include "core/tt_arena.h"
+#include "core/tt_simd.h"
+#include "core/tt_radix_sort.h"
+#include "core/tt_thread_pool.h"
+#include "octree/space_curve.h"
 
-template <typename PosType, typename DataType, size_t DIM>
+/**
+ * @brief 	 [简介] 子节点引用方式: 64 位指针, 节点分配在 Arena 中(默认)
+ */
+struct PointerRef
+{
+    template <typename T> using Ref = T*;
+    template <typename T> using Pool = Arena<T>;
+
+    template <typename T> static T *null() { return nullptr; }
+    template <typename T> static T *get(const Arena<T>&, T *ref) { return ref; }
+    template <typename T> static T *ref(const Arena<T>&, T *node) { return node; }
+    template <typename T> static T *rebase(T *ref, size_t) { return ref; }
+};
+
+/**
+ * @brief 	 [简介] 子节点引用方式: 32 位下标, 节点分配在 IndexArena 中
+ * @note 	 [注意] 拓扑内存减半, 且拓扑只依赖下标, 与内存地址无关, 可以用 Octree::export_image 导出为一段连续内存,
+ *                  按字节拷贝后用 import_image 恢复; 代价是访问子节点时多一次查块表, 新建节点时由地址反查下标
+ */
+struct IndexRef
+{
+    template <typename T> using Ref = uint32_t;
+    template <typename T> using Pool = IndexArena<T>;
+
+    template <typename T> static uint32_t null() { return IndexArena<T>::npos; }
+    template <typename T> static T *get(const IndexArena<T>& pool, uint32_t ref) { return ref == IndexArena<T>::npos ? nullptr : pool.at(ref); }
+    template <typename T> static uint32_t ref(const IndexArena<T>& pool, T *node) { return node == nullptr ? IndexArena<T>::npos : pool.index_of(node); }
+    template <typename T> static uint32_t rebase(uint32_t ref, size_t offset) { return ref == IndexArena<T>::npos ? ref : uint32_t(ref + offset); }
+};
+
+/**
+ * @brief 	 [简介] 稠密子节点表: 每个子区域一个引用, 按子区域id直接访问(DIM <= 3 时使用)
+ */
+template <typename RefPolicy, typename Node, size_t N>
+class DenseChildren {
+public:
+    using Ref = typename RefPolicy::template Ref<Node>;
+    constexpr static bool sparse_ = false;
+
+    DenseChildren() { for (size_t i = 0; i < N; ++i) refs_[i] = RefPolicy::template null<Node>(); }
+
+    Ref get(size_t index) const { return refs_[index]; }
+    void set(size_t index, Ref ref) { refs_[index] = ref; }
+
+    /**
+     * @brief 	 [简介] 节点之外额外占用的内存(字节)
+     */
+    size_t heap_bytes() const { return 0; }
+private:
+    Ref refs_[N];
+};
+
+/**
+ * @brief 	 [简介] 稀疏子节点表: 只保存存在的子节点, 按子区域id排序, 二分查找(DIM > 3 时使用)
+ * @note 	 [注意] 2^DIM 个子区域中通常只有少数存在, 内存与实际分支数成正比;
+ *                  对 4 维(x, y, z, t)或 6 维位姿空间, 稠密表每个节点需要 16 ~ 64 个引用
+ */
+template <typename RefPolicy, typename Node, size_t N>
+class SparseChildren {
+public:
+    using Ref = typename RefPolicy::template Ref<Node>;
+    constexpr static bool sparse_ = true;
+
+    Ref get(size_t index) const
+    {
+        auto it = lower_bound(index);
+        return it != entries_.end() && it->index == index ? it->ref : RefPolicy::template null<Node>();
+    }
+
+    void set(size_t index, Ref ref)
+    {
+        auto it = lower_bound(index);
+        bool found = it != entries_.end() && it->index == index;
+        if (ref == RefPolicy::template null<Node>()) {
+            if (found) entries_.erase(it);
+        } else if (found) {
+            it->ref = ref;
+        } else {
+            entries_.insert(it, Entry{uint32_t(index), ref});
+        }
+    }
+
+    size_t heap_bytes() const { return entries_.capacity() * sizeof(Entry); }
+private:
+    struct Entry
+    {
+        uint32_t index;
+        Ref ref;
+    };
+
+    typename std::vector<Entry>::const_iterator lower_bound(size_t index) const
+    {
+        return std::lower_bound(entries_.begin(), entries_.end(), index,
+                                [](const Entry& entry, size_t index) { return entry.index < index; });
+    }
+
+    typename std::vector<Entry>::iterator lower_bound(size_t index)
+    {
+        return std::lower_bound(entries_.begin(), entries_.end(), index,
+                                [](const Entry& entry, size_t index) { return entry.index < index; });
+    }
+private:
+    std::vector<Entry> entries_;
+};
+
+template <typename PosType, typename DataType, size_t DIM, typename RefPolicy = PointerRef, typename Coord = PosType> class OctreeCodec;
+
+/**
+ * @brief 	 [简介] 四叉树/八叉树
+ * @note 	 [注意] RefPolicy 决定子节点的引用方式(PointerRef 或 IndexRef), 对外接口不变, 子节点统一通过 child 访问;
+ *                  DIM <= 3 时子节点表为稠密数组, DIM > 3 时为稀疏表(SparseChildren);
+ *                  Coord 为树内部使用的坐标类型(节点中心), 默认与 PosType 相同; 可以是 float 向量,
+ *                  也可以是整数向量(定点数, 边界映射到 [0, 2^30], 深度最多 28 层); 只在接口处与 PosType 转换
+ */
+template <typename PosType, typename DataType, size_t DIM, typename RefPolicy = PointerRef, typename Coord = PosType>
 class Octree {
+    template <typename, typename, size_t, typename, typename> friend class OctreeCodec;
 public:
     constexpr static size_t child_num_ = 1 << DIM;
+    using Scalar = typename std::decay<decltype(std::declval<Coord&>()[0])>::type;
+    constexpr static bool fixed_point_ = std::is_integral<Scalar>::value;
+    // 最大深度的上限, 超过时构造函数截断、load 拒绝; 定点坐标的边界为 2^30, 第 28 层的半尺寸为 2, 再深中心不再可分;
+    // 超过编码长度 key_levels_ 的部分, 基于编码的接口(find_sorted, 哈希索引, Hilbert 序)按坐标或子区域id处理, diff 按路径记录
+    constexpr static size_t max_depth_limit_ = fixed_point_ ? 28 : 64;
+    // 节点编码: 从第 1 层开始依次拼接各层的子区域id, 深度最多 key_levels_ 层
+    using Key = uint64_t;
+    constexpr static size_t key_levels_ = 64 / DIM;
+    constexpr static size_t hash_levels_ = 63 / DIM;   // 哈希索引的层数, 位置码比编码多一个标志位
+    constexpr static size_t batch_group_ = 16;     // 批量查找时同时下降的查询数
     struct Node
     {
-        PosType center;
+        Coord center;       // 内部坐标, 用 Octree::position 转换为 PosType
         DataType data;
         size_t depth;
-        Node *childs[child_num_];
+        uint32_t stamp;     // 最近一次被插入或查找经过的时刻
+        uint32_t version;   // 子树最近一次被修改时的版本号, 修改会向上传递到根节点
+        typename std::conditional<(DIM > 3), SparseChildren<RefPolicy, Node, child_num_>,
+                                  DenseChildren<RefPolicy, Node, child_num_>>::type childs;
 
-        Node() : center(PosType()), data(DataType()), depth(0) {
-            for (size_t i = 0; i < child_num_; ++i) childs[i] = nullptr;
-        }
+        Node() : center(Coord()), data(DataType()), depth(0), stamp(0), version(0) { }
 
-        Node(const PosType& center, const DataType& data, size_t depth) 
-            : center(center), data(data), depth(depth) {
-            for (size_t i = 0; i < child_num_; ++i) childs[i] = nullptr;
-        }
+        Node(const Coord& center, const DataType& data, size_t depth) 
+            : center(center), data(data), depth(depth), stamp(0), version(0) { }
+    };
+    using NodeArena = typename RefPolicy::template Pool<Node>;
 
-        ~Node() { 
-            for (size_t i = 0; i < child_num_; ++i) {
-                if (childs[i] != nullptr) {
-                    delete childs[i];
-                }
-            }
-        }
+    enum class DiffType { ADDED, REMOVED, CHANGED };
+    enum class SetOp { UNION, INTERSECTION, DIFFERENCE };
+    enum class Layout { DFS, BFS, VEB, HILBERT };   // 节点重排顺序: 深度优先前序 / 层序 / van Emde Boas / 按 Hilbert 序访问子节点的前序
+
+    /**
+     * @brief 	 [简介] 两棵树之间的单个节点差异
+     * @note 	 [注意] ADDED 和 CHANGED 带有新数据; REMOVED 只记录被删除子树的根节点;
+     *                  路径逐层保存, 不受编码长度 key_levels_ 的限制
+     */
+    struct NodeDiff
+    {
+        DiffType type;
+        std::vector<uint32_t> path;     // 从根节点到该节点每层的子区域id, 长度即节点深度
+        DataType data;
     };
 
     struct Boundary
@@ -65,33 +213,98 @@ public:
          * @param 	 pos [in], 点位置 
          * @return 	 [true] or [false]
          */
-        bool is_in(const PosType& pos)
-        {
-            for (size_t i = 0; i < DIM; ++i) {
-                if (pos[i] < min[i] || pos[i] > max[i]) return false;
-            }
-            return true;
-        }
+        bool is_in(const PosType& pos) const { return VecKernel<PosType, DIM>::is_in(pos, min, max); }
     };
 
     /**
      * @brief 	 [简介] 构造函数
      * @param 	 min [in], 边界最小值 
      * @param 	 max [in], 边界最大值
-     * @param 	 depth [in], 最大深度
+     * @param 	 depth [in], 最大深度, 超过 max_depth_limit_ 时按 max_depth_limit_
      */
     Octree(const PosType& min, const PosType& max, size_t depth) 
-        :boundary_(Boundary(min, max)), max_depth_(depth)
+        :max_depth_(std::min(depth, size_t(max_depth_limit_))), memory_limit_(0), tick_(0), version_(1),
+         dense_levels_(0), hashed_(false), index_valid_(false)
     {
-        root_ = new Node(boundary_.center(), DataType(), 0);
+        set_boundary(Boundary(min, max));
+        root_ = arena_.create(center_, DataType(), 0);
     }
 
     /**
      * @brief 	 [简介] 析构函数
      */
-    ~Octree()
+    virtual ~Octree()
     {   
-        delete root_;
+        release();
+    }
+
+    Octree(const Octree&) = delete;
+    Octree& operator=(const Octree&) = delete;
+
+    /**
+     * @brief 	 [简介] 按 alignof(Octree) 分配, 成员中的 Eigen 向量化类型在堆上同样对齐
+     * @note 	 [注意] C++14 的 new 不保证超过 16 字节的对齐; 节点由内存池分配, 同样满足 alignof(Node)
+     */
+    static void *operator new(size_t bytes) { return aligned_malloc(bytes, alignof(Octree) > sizeof(void*) ? alignof(Octree) : sizeof(void*)); }
+    static void operator delete(void *ptr) { aligned_free(ptr); }
+
+    /**
+     * @brief 	 [简介] 移动构造, 只转移根节点和内存池, 不拷贝节点
+     * @note 	 [注意] 被移动的树只能析构或被重新赋值
+     */
+    Octree(Octree&& other) noexcept
+        : boundary_(other.boundary_), offset_(other.offset_), scale_(other.scale_), size_(other.size_), center_(other.center_),
+          half_sizes_(other.half_sizes_),
+          max_depth_(other.max_depth_),
+          memory_limit_(other.memory_limit_), tick_(other.tick_), version_(other.version_),
+          dense_levels_(other.dense_levels_), hashed_(other.hashed_), index_valid_(other.index_valid_),
+          dense_(std::move(other.dense_)), table_(std::move(other.table_)),
+          arena_(std::move(other.arena_)), root_(other.root_)
+    {
+        other.root_ = nullptr;
+        other.index_valid_ = false;
+    }
+
+    /**
+     * @brief 	 [简介] 移动赋值
+     */
+    Octree& operator=(Octree&& other) noexcept
+    {
+        if (this != &other) {
+            release();
+            boundary_ = other.boundary_;
+            offset_ = other.offset_;
+            scale_ = other.scale_;
+            size_ = other.size_;
+            center_ = other.center_;
+            half_sizes_ = other.half_sizes_;
+            max_depth_ = other.max_depth_;
+            memory_limit_ = other.memory_limit_;
+            tick_ = other.tick_;
+            version_ = other.version_;
+            dense_levels_ = other.dense_levels_;
+            hashed_ = other.hashed_;
+            index_valid_ = other.index_valid_;
+            dense_ = std::move(other.dense_);
+            table_ = std::move(other.table_);
+            arena_ = std::move(other.arena_);
+            root_ = other.root_;
+            other.root_ = nullptr;
+            other.index_valid_ = false;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief 	 [简介] 深拷贝整棵树, 根节点的各个子树在不同线程中拷贝到新的内存池
+     * @return 	 [Octree] 返回拷贝
+     * @note 	 [注意] 返回的是 Octree 本身, 派生类可以用 copy_from 实现自己的 clone
+     */
+    Octree clone() const
+    {
+        Octree tree(boundary_.min, boundary_.max, max_depth_);
+        tree.copy_from(*this);
+        return tree;
     }
 
     /**
@@ -104,7 +317,12 @@ public:
         // TODO: 之后加点越界打印
         if(!boundary_.is_in(pos)) return;
 
-        insert(root_, pos, data);
+        ++tick_;
+        root_->stamp = tick_;
+        root_->version = version_;
+        insert(root_, to_coord(pos), data);
+
+        if (memory_limit_ != 0 && arena_.size() * sizeof(Node) > memory_limit_) coarsen(memory_limit_ / 4 * 3);
     }
 
     /**
@@ -120,18 +338,126 @@ public:
      * @param 	 depth [in], 查找深度
      * @return 	 [Node*], 返回节点指针
      */
-    Node *find(const PosType& pos, const size_t& depth) { return find(root_, pos, depth); }
+    Node *find(const PosType& pos, const size_t& depth) { return find_coord(to_coord(pos), depth); }
+
+    /**
+     * @brief 	 [简介] 批量插入, 直接读取列主序的点矩阵, 不构造 PosType
+     * @param 	 points [in], DIM 行 N 列的点矩阵, 如 Eigen::Matrix3Xf, Eigen::Map<const Eigen::Matrix2Xd>, Eigen::Ref
+     * @param 	 datas [in], N 个点的数据, 为 nullptr 时都插入 DataType()
+     * @note 	 [注意] 逐点的结果与依次调用 insert 相同, 越界的点被跳过
+     */
+    template <typename Points>
+    void insert_batch(const Points& points, const DataType *datas)
+    {
+        for (size_t j = 0; j < size_t(points.cols()); ++j) {
+            Coord coord;
+            if (!column_coord(points, j, coord)) continue;
+
+            ++tick_;
+            root_->stamp = tick_;
+            root_->version = version_;
+            insert(root_, coord, datas == nullptr ? DataType() : datas[j]);
+
+            if (memory_limit_ != 0 && arena_.size() * sizeof(Node) > memory_limit_) coarsen(memory_limit_ / 4 * 3);
+        }
+    }
+
+    /**
+     * @brief 	 [简介] 批量查找, 结果写入预先分配好的输出, 不分配中间数组
+     * @param 	 points [in], DIM 行 N 列的点矩阵
+     * @param 	 nodes [out], N 个节点指针, 与逐点调用 find(pos, depth) 的结果相同
+     * @param 	 depth [in], 查找深度
+     * @note 	 [注意] 多个查询交错下降以隐藏访存延迟, 见 find_interleaved
+     */
+    template <typename Points>
+    void find_batch(const Points& points, Node **nodes, size_t depth)
+    {
+        find_interleaved(points, depth, [nodes](size_t j, Node *node) { nodes[j] = node; });
+    }
+
+    /**
+     * @brief 	 [简介] 批量查找, 先按节点编码(Morton 序)排序, 再对每个公共前缀只下降一次
+     * @param 	 points [in], DIM 行 N 列的点矩阵
+     * @param 	 nodes [out], N 个节点指针, 按输入顺序写入, 与逐点调用 find(pos, depth) 的结果相同
+     * @param 	 depth [in], 查找深度
+     * @note 	 [注意] 查询集中在同一区域时, 上层路径只访问一次; 整批查询共用一个访问时刻;
+     *                  编码只有 DIM * depth 位有效, 用基数排序只排这些位;
+     *                  编码最多 key_levels_ 层, 更深的部分逐点按坐标继续下降
+     */
+    template <typename Points>
+    void find_sorted(const Points& points, Node **nodes, size_t depth)
+    {
+        size_t num = size_t(points.cols());
+        size_t bottom = std::min(depth, max_depth_ == 0 ? size_t(0) : max_depth_ - 1);
+        size_t levels = std::min(bottom, size_t(key_levels_));
+        std::vector<Key> keys(num);
+        std::vector<uint32_t> ids(num);
+        for (size_t j = 0; j < num; ++j) {
+            Coord coord;
+            column_coord(points, j, coord);
+            keys[j] = coord_key(coord, levels);
+            ids[j] = uint32_t(j);
+        }
+        radix_sort(keys.data(), ids.data(), num, DIM * levels);
+
+        if (memory_limit_ != 0) ++tick_;
+        find_sorted(root_, keys.data(), keys.data() + num, ids.data(), levels, nodes);
+        if (bottom == levels) return;
+        for (size_t j = 0; j < num; ++j) {
+            if (nodes[j]->depth < levels) continue;
+            Coord coord;
+            column_coord(points, j, coord);
+            nodes[j] = find(nodes[j], coord, bottom);
+        }
+    }
+
+    /**
+     * @brief 	 [简介] 批量查找节点数据和节点中心
+     * @param 	 points [in], DIM 行 N 列的点矩阵
+     * @param 	 datas [out], 长度为 N, 支持 datas[j] 赋值, 如 Eigen::VectorXd, Eigen::Map<Eigen::VectorXf>
+     * @param 	 centers [out], DIM 行 N 列, 支持 centers(i, j) 赋值, 写入节点中心
+     * @param 	 depth [in], 查找深度
+     * @note 	 [注意] 输出按引用转发, 可以直接传入 Eigen::Map 临时对象
+     */
+    template <typename Points, typename Datas, typename Centers>
+    void find_batch(const Points& points, Datas&& datas, Centers&& centers, size_t depth)
+    {
+        find_interleaved(points, depth, [this, &datas, &centers](size_t j, const Node *node) {
+            datas[j] = node->data;
+            for (size_t i = 0; i < DIM; ++i) centers(i, j) = to_pos(i, node->center[i]);
+        });
+    }
 
     /**
      * @brief 	 [简介] 找到节点的边界
      * @param 	 node [in], 需要找到边界的节点 
      * @param 	 boundary [in], 边界 
      */
-    void find_boundary(Node* node, Boundary& boundary)
+    void find_boundary(const Node* node, Boundary& boundary) const
+    {
+        const Coord& half_size = half_sizes_[node->depth];
+        boundary.min = to_pos(node->center - half_size);
+        boundary.max = to_pos(node->center + half_size);
+    }
+
+    /**
+     * @brief 	 [简介] 节点中心的位置
+     * @param 	 node [in], 节点
+     * @return 	 [PosType] 返回节点中心, Coord 与 PosType 相同时就是 node->center
+     */
+    PosType position(const Node* node) const { return to_pos(node->center); }
+
+    /**
+     * @brief 	 [简介] 第 depth 层节点的半尺寸, 与 find_boundary 和子节点中心使用同一张表
+     * @param 	 depth [in], 深度, 不超过 max_depth
+     * @return 	 [PosType] 返回半尺寸, 用于导出的只读副本计算节点边界和子节点中心
+     */
+    PosType half_size(size_t depth) const
     {
-        PosType half_size = boundary_.size() / (1 << (node->depth + 1));
-        boundary.min = node->center - half_size;
-        boundary.max = node->center + half_size;
+        PosType half = boundary_.min;
+        const Coord& coord = half_sizes_[std::min(depth, half_sizes_.size() - 1)];
+        for (size_t i = 0; i < DIM; ++i) half[i] = double(coord[i]) / scale_[i];
+        return half;
     }
 
     /**
@@ -139,112 +465,1564 @@ public:
      * @param 	 func [in], 可视化函数 
      */
     void visual(std::function<void(Node* node)> func = nullptr) { traverse(root_, func);}
-protected:
+
     /**
-     * @brief 	 [简介] 遍历树
-     * @param 	 node [in], 需要遍历的节点 
-     * @param 	 func [in], 遍历函数
+     * @brief 	 [简介] 范围查询, 访问与矩形/长方体相交的节点
+     * @param 	 min [in], 查询框最小值
+     * @param 	 max [in], 查询框最大值
+     * @param 	 func [in], 访问函数, 只访问深度为 depth 的节点或更浅的叶子节点
+     * @param 	 depth [in], 查询深度, 默认为最大深度
      */
-    void traverse(Node *node, std::function<void(Node* node)> func)
+    void query_box(const PosType& min, const PosType& max, std::function<void(Node* node)> func)
     {
-        if (node == nullptr) return;
-        func(node);
-        for (size_t i = 0; i < child_num_; i++) {
-            if(node->childs[i] != nullptr){
-                traverse(node->childs[i], func);
+        query_box(min, max, func, max_depth_);
+    }
+
+    void query_box(const PosType& min, const PosType& max, std::function<void(Node* node)> func, size_t depth)
+    {
+        query_box(root_, to_coord(min), to_coord(max), func, depth);
+    }
+
+    /**
+     * @brief 	 [简介] 半径查询, 访问与圆/球相交的节点
+     * @param 	 center [in], 球心
+     * @param 	 radius [in], 半径
+     * @param 	 func [in], 访问函数, 只访问深度为 depth 的节点或更浅的叶子节点
+     * @param 	 depth [in], 查询深度, 默认为最大深度
+     */
+    void query_radius(const PosType& center, double radius, std::function<void(Node* node)> func)
+    {
+        query_radius(center, radius, func, max_depth_);
+    }
+
+    void query_radius(const PosType& center, double radius, std::function<void(Node* node)> func, size_t depth)
+    {
+        query_radius(root_, center, radius * radius, func, depth);
+    }
+
+    /**
+     * @brief 	 [简介] 获取根节点, 用于导出只读副本
+     * @return 	 [const Node*] 返回根节点指针
+     */
+    const Node *root() const { return root_; }
+
+    /**
+     * @brief 	 [简介] 获取子节点
+     * @param 	 node [in], 本树的节点
+     * @param 	 index [in], 子区域id
+     * @return 	 [Node*] 返回子节点指针, 不存在时返回 nullptr
+     */
+    Node *child(const Node *node, size_t index) const { return RefPolicy::get(arena_, node->childs.get(index)); }
+
+    /**
+     * @brief 	 [简介] 获取树的边界
+     * @return 	 [const Boundary&] 返回边界
+     */
+    const Boundary& boundary() const { return boundary_; }
+
+    /**
+     * @brief 	 [简介] 获取树的最大深度
+     * @return 	 [size_t] 返回最大深度
+     */
+    size_t max_depth() const { return max_depth_; }
+
+    /**
+     * @brief 	 [简介] 节点数量
+     */
+    size_t size() const { return arena_.size(); }
+
+    /**
+     * @brief 	 [简介] 树占用的内存(字节), 包括内存池中尚未使用的部分
+     * @note 	 [注意] 稀疏子节点表在堆上的部分需要遍历统计
+     */
+    size_t memory_usage() const
+    {
+        size_t bytes = sizeof(*this) + arena_.bytes();
+        if (decltype(root_->childs)::sparse_ && root_ != nullptr) bytes += heap_bytes(root_);
+        return bytes;
+    }
+
+    /**
+     * @brief 	 [简介] 设置节点内存上限, 超过时把最久未访问的深层子树合并到父节点
+     * @param 	 bytes [in], 存活节点占用的字节数上限, 0 表示不限制
+     * @note 	 [注意] 合并后损失分辨率, 但父节点的数据本身就是子树的汇总, 总量不变;
+     *                  每次超限会一直合并到上限的 3/4, 避免频繁触发;
+     *                  只有设置了上限时查找才记录访问时刻, 不限制时查找不写节点和时钟
+     */
+    void set_memory_limit(size_t bytes)
+    {
+        memory_limit_ = bytes;
+        if (memory_limit_ != 0 && arena_.size() * sizeof(Node) > memory_limit_) coarsen(memory_limit_ / 4 * 3);
+    }
+
+    size_t memory_limit() const { return memory_limit_; }
+
+    /**
+     * @brief 	 [简介] 设置稠密层数: 第 levels 层的节点按编码放入一个隐式数组, 
+     *                   查找时由坐标直接算出下标定位到该层, 跳过前 levels 次指针跳转
+     * @param 	 levels [in], 稠密层数, 0 表示关闭; 数组有 child_num_^levels 项, levels * DIM 最多为 24
+     * @note 	 [注意] 上层节点仍然保留(它们的数据是子树的汇总), 数组只是索引, 在下一次查找时按需重建;
+     *                  通过数组跳过的祖先节点不更新访问时刻
+     */
+    void set_dense_levels(size_t levels)
+    {
+        dense_levels_ = std::min(levels, size_t(24 / DIM));
+        dense_.clear();
+        index_valid_ = false;
+    }
+
+    size_t dense_levels() const { return dense_levels_; }
+
+    /**
+     * @brief 	 [简介] 开启/关闭哈希索引: (深度, 编码) -> 节点
+     * @param 	 enable [in], 是否开启
+     * @note 	 [注意] 开启后 find 在层之间二分查找路径上最深的节点, 只需 O(log depth) 次哈希查找,
+     *                  find_by_key 只需一次; 代价是每个节点额外约 32 字节, 且只更新返回节点的访问时刻;
+     *                  只索引前 hash_levels_ 层, 更深的部分从该层的节点按指针下降
+     */
+    void set_hash_index(bool enable)
+    {
+        hashed_ = enable;
+        table_.clear();
+        index_valid_ = false;
+    }
+
+    bool hash_index() const { return hashed_; }
+
+    /**
+     * @brief 	 [简介] 合并冷子树直到存活节点的字节数不超过 bytes
+     * @param 	 bytes [in], 目标字节数
+     * @note 	 [注意] 每轮只合并子节点全是叶子的节点, 按最近访问时刻从旧到新、深度从深到浅的顺序;
+     *                  根节点不参与合并
+     */
+    void coarsen(size_t bytes)
+    {
+        std::vector<Node*> candidates;
+        while (arena_.size() * sizeof(Node) > bytes) {
+            candidates.clear();
+            find_coarsen_candidates(root_, candidates);
+            if (candidates.empty()) break;
+
+            std::sort(candidates.begin(), candidates.end(), [](const Node *a, const Node *b) {
+                return a->stamp != b->stamp ? a->stamp < b->stamp : a->depth > b->depth;
+            });
+            for (Node *node : candidates) {
+                if (arena_.size() * sizeof(Node) <= bytes) break;
+                for (size_t i = 0; i < child_num_; ++i) {
+                    clear(child(node, i));
+                    set_child(node, i, nullptr);
+                }
+                node->version = version_;
             }
         }
+        index_valid_ = false;
+        propagate_version(root_);
     }
 
     /**
-     * @brief 	 [简介] 插入点
-     * @param 	 node [in], 插入节点
-     * @param 	 pos [in], 插入点位置
-     * @param 	 data [in], 插入点数据
-     * @note 	 [注意] 递归插入
+     * @brief 	 [简介] 按指定顺序把所有节点重新分配到新的内存池中, 使查询时访问的节点在内存中相邻
+     * @param 	 layout [in], DFS 适合单点查找和深度优先的范围查询; BFS 适合浅层的粗查询;
+     *                   VEB 与缓存大小无关, 任意深度的路径都只跨越较少的缓存行;
+     *                   HILBERT 与 DFS 相同但子节点按 Hilbert 序排列, 空间上相邻的叶子在内存中也相邻, 适合长条形的范围查询;
+     *                   超过 hilbert_levels 层的子节点按子区域id排列
+     * @note 	 [注意] 适合在批量建图之后、进入以查询为主的阶段之前调用一次; 之前得到的节点指针全部失效
      */
-    void insert(Node *node, const PosType& pos, const DataType& data)
+    void optimize_layout(Layout layout)
     {
-        if (node->depth+1 == max_depth_) return;
-
-        size_t index = find_index(pos, node);
+        std::vector<Node*> order;
+        order.reserve(arena_.size());
+        switch (layout) {
+        case Layout::DFS:
+            traverse(root_, [&order](Node *node) { order.push_back(node); });
+            break;
+        case Layout::BFS:
+            order.push_back(root_);
+            for (size_t cur = 0; cur < order.size(); ++cur) {
+                for (size_t i = 0; i < child_num_; ++i) {
+                    if (child(order[cur], i) != nullptr) order.push_back(child(order[cur], i));
+                }
+            }
+            break;
+        case Layout::VEB:
+            veb_order(root_, std::max<size_t>(max_depth_, 1), order);
+            break;
+        case Layout::HILBERT:
+            hilbert_order(root_, 0, order);
+            break;
+        }
 
-        if (node->childs[index] == nullptr) {
-            node->childs[index] = new Node(find_center(pos, node), data, node->depth + 1);
-        }else{
-            node->childs[index]->data = update(node->childs[index]->data, data);
+        NodeArena arena;
+        std::unordered_map<const Node*, Node*> moved;
+        moved.reserve(order.size());
+        for (Node *node : order) moved[node] = arena.create(*node);
+        for (Node *node : order) {
+            Node *copy = moved[node];
+            for (size_t i = 0; i < child_num_; ++i) {
+                Node *next = child(node, i);
+                copy->childs.set(i, RefPolicy::ref(arena, next == nullptr ? nullptr : moved[next]));
+            }
         }
 
-        insert(node->childs[index], pos, data);
+        Node *root = moved[root_];
+        release();
+        arena_ = std::move(arena);
+        root_ = root;
     }
-    
+
     /**
-     * @brief 	 [简介] 更新节点数据方法, 默认为加法
-     * @param 	 old_data [in], 原节点数据 
-     * @param 	 new_data [in], 新节点数据
-     * @return 	 [DataType] 返回更新后的数据
+     * @brief 	 [简介] 整理内存: 按深度优先前序重排节点, 同时去掉删除节点留下的空洞
      */
-    virtual DataType update(DataType& old_data, const DataType& new_data)
+    void compact() { optimize_layout(Layout::DFS); }
+
+    /**
+     * @brief 	 [简介] 获取当前版本号, 不修改树; 当前的修改都标记为这个版本
+     */
+    uint32_t version() const { return version_; }
+
+    /**
+     * @brief 	 [简介] 结束当前版本, 之后的修改都属于更新的版本
+     * @return 	 [uint32_t] 返回结束的版本号, 可传给 for_each_changed_since
+     * @note 	 [注意] 版本号只在调用本函数时递增, 与修改次数无关
+     */
+    uint32_t checkpoint() { return version_++; }
+
+    /**
+     * @brief 	 [简介] 访问自 version 之后被修改过的节点, 代价与修改量成正比
+     * @param 	 version [in], 由 checkpoint() 得到的版本号
+     * @param 	 func [in], 访问函数, 父节点先于子节点
+     * @note 	 [注意] 被删除的节点不会被访问, 其父节点会被访问, 使用者可以重新导出父节点的子树
+     */
+    void for_each_changed_since(uint32_t version, std::function<void(Node* node)> func)
     {
-        return (new_data + old_data);
+        changed_since(root_, version, func);
     }
 
     /**
-     * @brief 	 [简介] 查找节点
-     * @param 	 node [in], 查找节点 
-     * @param 	 pos [in], 查找点位置 
-     * @param 	 depth [in], 查找深度 
-     * @return 	 [Node*] 返回查找到的节点
-     * @note 	 [注意] 递归查找
+     * @brief 	 [简介] 以二进制形式完整保存树, 节点中心不保存, 加载时重新计算
+     * @param 	 os [in], 输出流
+     * @return 	 [true] 成功 or [false] 写入失败
+     * @note 	 [注意] DataType 必须可以按字节拷贝
      */
-    Node *find(Node *node, const PosType& pos, const size_t& depth)
+    bool save(std::ostream& os) const
     {
-        if (node->depth == depth) return node;
+        static_assert(std::is_trivially_copyable<DataType>::value, "DataType must be trivially copyable");
+        uint32_t dim = DIM;
+        uint64_t max_depth = max_depth_;
+        write(os, dim);
+        write(os, max_depth);
+        for (size_t i = 0; i < DIM; ++i) {
+            double min = boundary_.min[i], max = boundary_.max[i];
+            write(os, min);
+            write(os, max);
+        }
+        save(os, root_);
+        return bool(os);
+    }
 
-        size_t index = find_index(pos, node);
+    /**
+     * @brief 	 [简介] 加载由 save 保存的树, 替换本树的内容
+     * @param 	 is [in], 输入流
+     * @return 	 [true] 成功 or [false] 格式不匹配或读取失败, 此时本树不变
+     * @note 	 [注意] 先加载到临时树中, 成功后再替换; 内存上限、索引设置和版本号保持不变
+     */
+    bool load(std::istream& is)
+    {
+        static_assert(std::is_trivially_copyable<DataType>::value, "DataType must be trivially copyable");
+        uint32_t dim = 0;
+        uint64_t max_depth = 0;
+        read(is, dim);
+        read(is, max_depth);
+        if (!is || dim != DIM || max_depth > max_depth_limit_) return false;
 
-        if (node->childs[index] == nullptr) return node;
+        Boundary boundary = boundary_;
+        for (size_t i = 0; i < DIM; ++i) {
+            double min = 0, max = 0;
+            read(is, min);
+            read(is, max);
+            boundary.min[i] = min;
+            boundary.max[i] = max;
+        }
+        if (!is) return false;
 
-        return find(node->childs[index], pos, depth);
+        Octree tree(boundary.min, boundary.max, max_depth);
+        if (!tree.load(is, tree.root_)) return false;
+        tree.memory_limit_ = memory_limit_;
+        tree.tick_ = tick_;
+        tree.version_ = version_;
+        tree.dense_levels_ = dense_levels_;
+        tree.hashed_ = hashed_;
+        tree.mark_subtree(tree.root_);
+        *this = std::move(tree);
+        return true;
     }
-private:
+
     /**
-     * @brief 	 [简介] 找到点所在的区域
-     * @param 	 pos [in], 点位置
-     * @param 	 node [in], 所在节点
-     * @return 	 [size_t] 返回点所在区域的id
-    */
-    size_t find_index(const PosType& pos, const Node *node)
+     * @brief 	 [简介] 导出与地址无关的镜像: 头部 + 空闲下标 + 按下标排列的全部节点, 节点部分是内存池的逐字节拷贝
+     * @return 	 [std::vector<uint8_t>] 返回镜像, 可以直接拷贝、写入文件或发送, 用 import_image 恢复
+     * @note 	 [注意] 只支持 IndexRef 和稠密子节点表(DIM <= 3): 子节点引用是下标, 拷贝后不需要修正;
+     *                  根节点以下标保存; 稠密层索引和哈希索引含有指针, 不导出, 恢复后按需重建;
+     *                  镜像依赖 Node 的内存布局, 只能在相同的类型和平台之间使用
+     */
+    std::vector<uint8_t> export_image() const
     {
-        size_t index = 0;
+        static_assert(std::is_same<RefPolicy, IndexRef>::value, "export_image requires IndexRef");
+        static_assert(!decltype(root_->childs)::sparse_, "sparse children keep entries on the heap");
+        static_assert(std::is_trivially_copyable<DataType>::value, "DataType must be trivially copyable");
+        ImageHeader header;
+        header.magic = image_magic_;
+        header.dim = DIM;
+        header.node_bytes = sizeof(Node);
+        header.max_depth = uint32_t(max_depth_);
+        header.root = arena_.index_of(root_);
+        header.version = version_;
+        header.capacity = arena_.capacity();
+        header.free_num = arena_.free_list().size();
         for (size_t i = 0; i < DIM; ++i) {
-            if (pos[i] > node->center[i]) index |= (1 << i);
+            header.min[i] = boundary_.min[i];
+            header.max[i] = boundary_.max[i];
         }
-        return index;
+
+        size_t free_bytes = header.free_num * sizeof(uint32_t);
+        std::vector<uint8_t> image(sizeof(header) + free_bytes + header.capacity * sizeof(Node));
+        std::memcpy(image.data(), &header, sizeof(header));
+        if (free_bytes != 0) std::memcpy(image.data() + sizeof(header), arena_.free_list().data(), free_bytes);
+        arena_.export_to(image.data() + sizeof(header) + free_bytes);
+        return image;
     }
 
     /**
-     * @brief 	 [简介] 找到点所在区域的中心
-     * @param 	 pos [in], 点位置 
-     * @param 	 node [in], 所在节点
-     * @return 	 [PosType] 返回点所在区域的中心
+     * @brief 	 [简介] 从 export_image 导出的镜像恢复, 替换本树的内容
+     * @param 	 data [in], 镜像, 可以位于任意地址, 不要求对齐
+     * @param 	 bytes [in], 镜像字节数
+     * @return 	 [true] 成功 or [false] 镜像不完整、类型不匹配或引用越界, 此时本树不变
+     * @note 	 [注意] 节点按字节拷贝回按块分配的内存池, 下标不变; 检查从根可达的每个引用, 不信任镜像内容
      */
-    PosType find_center(const PosType& pos, const Node *node)
+    bool import_image(const uint8_t *data, size_t bytes)
     {
-        PosType center = node->center;
-        PosType half_size = boundary_.size() / (1 << (node->depth + 2));
-        for (size_t i = 0; i < DIM; ++i) {
-            center[i] = (pos[i] > node->center[i]) ? center[i] + half_size[i] : center[i] - half_size[i];
+        static_assert(std::is_same<RefPolicy, IndexRef>::value, "import_image requires IndexRef");
+        static_assert(!decltype(root_->childs)::sparse_, "sparse children keep entries on the heap");
+        static_assert(std::is_trivially_copyable<DataType>::value, "DataType must be trivially copyable");
+        ImageHeader header;
+        if (bytes < sizeof(header)) return false;
+        std::memcpy(&header, data, sizeof(header));
+        if (header.magic != image_magic_ || header.dim != DIM || header.node_bytes != sizeof(Node)) return false;
+        if (header.max_depth == 0 || header.max_depth > max_depth_limit_) return false;
+        if (header.capacity > IndexArena<Node>::npos || header.root >= header.capacity || header.free_num > header.capacity) return false;
+        size_t free_bytes = header.free_num * sizeof(uint32_t);
+        if (bytes != sizeof(header) + free_bytes + header.capacity * sizeof(Node)) return false;
+
+        // valid[i]: 下标 i 是尚未访问的存活节点
+        std::vector<uint32_t> free(header.free_num);
+        if (free_bytes != 0) std::memcpy(free.data(), data + sizeof(header), free_bytes);
+        std::vector<bool> valid(header.capacity, true);
+        for (uint32_t index : free) {
+            if (index >= header.capacity || !valid[index]) return false;
+            valid[index] = false;
         }
+        NodeArena arena;
+        arena.import_from(data + sizeof(header) + free_bytes, header.capacity, std::move(free));
+        if (!check_image(arena, header.root, 0, header.max_depth, valid)) return false;
 
-        return center;
+        Boundary boundary = boundary_;
+        for (size_t i = 0; i < DIM; ++i) {
+            boundary.min[i] = header.min[i];
+            boundary.max[i] = header.max[i];
+        }
+        release();
+        set_boundary(boundary);
+        max_depth_ = header.max_depth;
+        version_ = header.version;
+        arena_ = std::move(arena);
+        root_ = arena_.at(header.root);
+        dense_.clear();
+        table_.clear();
+        return true;
     }
-private:
-    Boundary boundary_;
-    size_t max_depth_;
-    Node *root_;
+
+    /**
+     * @brief 	 [简介] 计算点在指定深度所在节点的编码, 只做数值计算, 不访问节点
+     * @param 	 pos [in], 点位置
+     * @param 	 depth [in], 深度, 超过 key_levels_ 时按 key_levels_ 计算
+     * @return 	 [Key] 返回节点编码
+     */
+    Key find_key(const PosType& pos, size_t depth) const { return coord_key(to_coord(pos), depth); }
+
+    /**
+     * @brief 	 [简介] 计算点在指定深度所在节点的 Hilbert 编码, 可用于批量插入前对点排序
+     * @param 	 pos [in], 点位置
+     * @param 	 depth [in], 深度, 超过 hilbert_bottom 时按 hilbert_bottom 计算
+     * @return 	 [Key] 返回节点在 Hilbert 序中的位置, 不同深度的结果可以一起比较(父节点的编码是子节点编码的前缀)
+     */
+    Key hilbert_key(const PosType& pos, size_t depth) const
+    {
+        depth = std::min(depth, hilbert_bottom());
+        return hilbert_prefix<DIM>(find_key(pos, depth), depth, hilbert_bottom());
+    }
+
+    /**
+     * @brief 	 [简介] 按编码查找节点
+     * @param 	 key [in], 节点编码
+     * @param 	 depth [in], 节点深度
+     * @return 	 [Node*] 返回节点指针, 不存在时返回 nullptr; depth 超过 key_levels_ 时编码无法表示该节点, 也返回 nullptr
+     */
+    Node *find_by_key(Key key, size_t depth)
+    {
+        if (depth > key_levels_) return nullptr;
+        if (hashed_ && depth <= hash_levels_) {
+            if (!index_valid_) rebuild_index();
+            return table_.find(location(key, depth));
+        }
+        Node *node = root_;
+        size_t d = depth;
+        if (dense_levels_ != 0 && depth >= dense_levels_) {
+            node = dense_at(key >> (DIM * (depth - dense_levels_)));
+            d = depth - dense_levels_;
+        }
+        for (; d > 0 && node != nullptr; --d) {
+            node = child(node, (key >> (DIM * (d - 1))) & (child_num_ - 1));
+        }
+        return node;
+    }
+
+    /**
+     * @brief 	 [简介] 把另一棵树合并进本树, 重叠的节点用 policy 合并数据,
+     *                   不重叠的子树直接移动指针, 不重新插入点
+     * @param 	 other [in], 被合并的树, 合并后只能析构或被重新赋值
+     * @param 	 policy [in], 数据合并方法, policy(本树数据, other数据)
+     * @return 	 [true] 合并成功 or [false] 边界或深度不同
+     */
+    template <typename Policy>
+    bool merge(Octree&& other, Policy policy)
+    {
+        if (this == &other || !same_layout(other)) return false;
+
+        // 先接管 other 的内存, 被嫁接的节点就属于本树了
+        rebase(other.root_, arena_.splice(other.arena_));
+        index_valid_ = false;
+        root_->data = policy(root_->data, other.root_->data);
+        root_->version = version_;
+        merge(root_, other.root_, policy);
+        arena_.destroy(other.root_);
+        other.root_ = nullptr;
+        return true;
+    }
+
+    /**
+     * @brief 	 [简介] 计算从本树到另一棵树的差异
+     * @param 	 other [in], 目标树, 边界和深度需相同
+     * @return 	 [std::vector<NodeDiff>] 返回差异(前序), 对本树依次 apply 后得到 other
+     */
+    std::vector<NodeDiff> diff(const Octree& other) const
+    {
+        std::vector<NodeDiff> diffs;
+        if (!same_layout(other)) return diffs;
+        std::vector<uint32_t> path;
+        diff(other, root_, other.root_, path, diffs);
+        return diffs;
+    }
+
+    /**
+     * @brief 	 [简介] 应用差异
+     * @param 	 diffs [in], 由 diff 计算出的差异
+     */
+    void apply(const std::vector<NodeDiff>& diffs)
+    {
+        index_valid_ = false;
+        for (const NodeDiff& diff : diffs) {
+            root_->version = version_;
+            if (diff.path.empty()) {
+                root_->data = diff.data;
+                continue;
+            }
+            Node *parent = root_;
+            for (size_t d = 0; d + 1 < diff.path.size() && parent != nullptr; ++d) {
+                parent = child(parent, diff.path[d]);
+                if (parent != nullptr) parent->version = version_;
+            }
+            if (parent == nullptr) continue;
+            size_t index = diff.path.back();
+            Node *node = child(parent, index);
+
+            if (diff.type == DiffType::REMOVED) {
+                clear(node);
+                set_child(parent, index, nullptr);
+                continue;
+            }
+            if (node == nullptr) {
+                node = arena_.create(child_center(parent, index), diff.data, diff.path.size());
+                set_child(parent, index, node);
+            } else {
+                node->data = diff.data;
+            }
+            node->version = version_;
+        }
+    }
+
+    /**
+     * @brief 	 [简介] 对两棵占据树做集合运算, 结果替换本树的内容
+     * @param 	 a [in], 左操作数
+     * @param 	 b [in], 右操作数, 边界和深度需与 a 相同
+     * @param 	 op [in], 并集/交集/差集
+     * @return 	 [true] 成功 or [false] 边界或深度不同
+     * @note 	 [注意] 节点存在即视为占据; 两棵树同步遍历, 遇到空子树或满子树时直接拷贝或丢弃整棵子树;
+     *                  结果叶子的数据优先取 a 的, 中间节点的数据由子节点重新 update 累加
+     */
+    bool set_operation(const Octree& a, const Octree& b, SetOp op)
+    {
+        if (!a.same_layout(b)) return false;
+
+        std::unordered_set<const Node*> full;
+        if (op == SetOp::UNION) a.find_full(a.root_, full);
+        else b.find_full(b.root_, full);
+
+        // a 或 b 可能就是本树, 结果先写入新的内存池
+        NodeArena arena;
+        Node *root = arena.create(a.root_->center, a.root_->data, 0);
+        for (size_t i = 0; i < child_num_; ++i) {
+            root->childs.set(i, RefPolicy::ref(arena, combine(a, a.child(a.root_, i), b, b.child(b.root_, i), op, full, arena)));
+        }
+
+        release();
+        set_boundary(a.boundary_);
+        max_depth_ = a.max_depth_;
+        arena_ = std::move(arena);
+        root_ = root;
+        mark_subtree(root_);
+        return true;
+    }
+protected:
+    /**
+     * @brief 	 [简介] 遍历树
+     * @param 	 node [in], 需要遍历的节点 
+     * @param 	 func [in], 遍历函数
+     */
+    void traverse(Node *node, std::function<void(Node* node)> func)
+    {
+        if (node == nullptr) return;
+        func(node);
+        for (size_t i = 0; i < child_num_; i++) {
+            if(child(node, i) != nullptr){
+                traverse(child(node, i), func);
+            }
+        }
+    }
+
+    /**
+     * @brief 	 [简介] 前序排列, 子节点按 Hilbert 序访问
+     * @param 	 node [in], 子树根节点
+     * @param 	 key [in], 子树根节点的 Morton 编码
+     * @param 	 order [out], 节点顺序
+     */
+    void hilbert_order(Node *node, Key key, std::vector<Node*>& order)
+    {
+        order.push_back(node);
+        size_t childs[child_num_];
+        for (size_t i = 0; i < child_num_; ++i) childs[i] = i;
+        if (node->depth < hilbert_bottom()) hilbert_child_order<DIM>(key, node->depth, hilbert_bottom(), childs);
+        for (size_t k = 0; k < child_num_; ++k) {
+            Node *next = child(node, childs[k]);
+            if (next != nullptr) hilbert_order(next, (key << DIM) | childs[k], order);
+        }
+    }
+
+    // Hilbert 编码统一在叶子层的网格上计算, 叶子层超过 hilbert_levels 时截断, 更深的子节点按子区域id排列
+    size_t hilbert_bottom() const { return ::hilbert_bottom<DIM>(max_depth_); }
+
+    /**
+     * @brief 	 [简介] van Emde Boas 顺序: 把 height 层的子树分成上半部分和若干下半部分子树, 递归排列
+     * @param 	 node [in], 子树根节点
+     * @param 	 height [in], 子树层数
+     * @param 	 order [out], 节点顺序
+     */
+    void veb_order(Node *node, size_t height, std::vector<Node*>& order)
+    {
+        if (height == 1) {
+            order.push_back(node);
+            return;
+        }
+        size_t top = height / 2;
+        veb_order(node, top, order);
+
+        // 上半部分最底层之下的节点, 即各个下半部分子树的根
+        std::vector<Node*> frontier(1, node);
+        for (size_t d = 0; d < top; ++d) {
+            std::vector<Node*> next;
+            for (Node *parent : frontier) {
+                for (size_t i = 0; i < child_num_; ++i) {
+                    if (child(parent, i) != nullptr) next.push_back(child(parent, i));
+                }
+            }
+            frontier.swap(next);
+        }
+        for (Node *bottom : frontier) veb_order(bottom, height - top, order);
+    }
+
+    /**
+     * @brief 	 [简介] 插入点
+     * @param 	 node [in], 插入节点
+     * @param 	 pos [in], 插入点位置
+     * @param 	 data [in], 插入点数据
+     * @note 	 [注意] 递归插入
+     */
+    void insert(Node *node, const Coord& pos, const DataType& data)
+    {
+        if (node->depth+1 == max_depth_) return;
+
+        size_t index = find_index(pos, node);
+        Node *next = child(node, index);
+
+        if (next == nullptr) {
+            next = arena_.create(find_center(pos, node), data, node->depth + 1);
+            set_child(node, index, next);
+            if (index_valid_ && next->depth == dense_levels_) dense_[coord_key(pos, dense_levels_)] = next;
+            if (index_valid_ && hashed_ && next->depth <= hash_levels_) table_.insert(location(coord_key(pos, next->depth), next->depth), next);
+        }else{
+            next->data = update(next->data, data);
+        }
+        next->stamp = tick_;
+        next->version = version_;
+
+        insert(next, pos, data);
+    }
+    
+    /**
+     * @brief 	 [简介] 更新节点数据方法, 默认为加法
+     * @param 	 old_data [in], 原节点数据 
+     * @param 	 new_data [in], 新节点数据
+     * @return 	 [DataType] 返回更新后的数据
+     */
+    virtual DataType update(DataType& old_data, const DataType& new_data)
+    {
+        return (new_data + old_data);
+    }
+
+    /**
+     * @brief 	 [简介] 记录查找经过节点的访问时刻, 只有设置了内存上限时合并才需要, 否则查找不写节点
+     * @param 	 node [in], 节点
+     * @param 	 tick [in], 访问时刻
+     */
+    void touch(Node *node, uint32_t tick)
+    {
+        if (memory_limit_ != 0) node->stamp = tick;
+    }
+
+    /**
+     * @brief 	 [简介] 查找节点
+     * @param 	 node [in], 查找节点 
+     * @param 	 pos [in], 查找点位置 
+     * @param 	 depth [in], 查找深度 
+     * @return 	 [Node*] 返回查找到的节点
+     * @note 	 [注意] 递归查找
+     */
+    Node *find(Node *node, const Coord& pos, const size_t& depth)
+    {
+        touch(node, tick_);
+        if (node->depth == depth) return node;
+
+        Node *next = child(node, find_index(pos, node));
+
+        if (next == nullptr) return node;
+
+        return find(next, pos, depth);
+    }
+
+    /**
+     * @brief 	 [简介] 递归访问版本号大于 version 的节点, 子树的版本号不超过其根节点的版本号
+     */
+    void changed_since(Node *node, uint32_t version, std::function<void(Node* node)>& func)
+    {
+        if (node == nullptr || node->version <= version) return;
+        func(node);
+        for (size_t i = 0; i < child_num_; ++i) changed_since(child(node, i), version, func);
+    }
+
+    /**
+     * @brief 	 [简介] 把子树中所有节点标记为当前版本
+     */
+    void mark_subtree(Node *node)
+    {
+        if (node == nullptr) return;
+        node->version = version_;
+        for (size_t i = 0; i < child_num_; ++i) mark_subtree(child(node, i));
+    }
+
+    /**
+     * @brief 	 [简介] 把当前版本的修改向上传递
+     * @return 	 [true] 子树中有当前版本修改过的节点 or [false]
+     */
+    bool propagate_version(Node *node)
+    {
+        bool changed = node->version == version_;
+        for (size_t i = 0; i < child_num_; ++i) {
+            if (child(node, i) != nullptr && propagate_version(child(node, i))) changed = true;
+        }
+        if (changed) node->version = version_;
+        return changed;
+    }
+
+    /**
+     * @brief 	 [简介] 找出子节点全是叶子的非根节点
+     * @param 	 node [in], 子树根节点
+     * @param 	 candidates [out], 可合并的节点
+     * @return 	 [true] node 是叶子 or [false]
+     */
+    bool find_coarsen_candidates(Node *node, std::vector<Node*>& candidates)
+    {
+        bool leaf = true, leaf_parent = true;
+        for (size_t i = 0; i < child_num_; ++i) {
+            if (child(node, i) == nullptr) continue;
+            leaf = false;
+            if (!find_coarsen_candidates(child(node, i), candidates)) leaf_parent = false;
+        }
+        if (!leaf && leaf_parent && node != root_) candidates.push_back(node);
+        return leaf;
+    }
+
+    /**
+     * @brief 	 [简介] 递归范围查询
+     * @param 	 node [in], 当前节点
+     * @param 	 min [in], 查询框最小值(内部坐标)
+     * @param 	 max [in], 查询框最大值(内部坐标)
+     * @param 	 func [in], 访问函数
+     * @param 	 depth [in], 查询深度
+     */
+    void query_box(Node *node, const Coord& min, const Coord& max, std::function<void(Node* node)>& func, size_t depth)
+    {
+        const Coord& half_size = half_sizes_[node->depth];
+        if (!VecKernel<Coord, DIM>::overlap(node->center, half_size, min, max)) return;
+
+        bool leaf = true;
+        if (node->depth < depth) {
+            for (size_t i = 0; i < child_num_; ++i) {
+                if (child(node, i) == nullptr) continue;
+                leaf = false;
+                query_box(child(node, i), min, max, func, depth);
+            }
+        }
+        if (leaf) func(node);
+    }
+
+    /**
+     * @brief 	 [简介] 递归半径查询
+     * @param 	 node [in], 当前节点
+     * @param 	 center [in], 球心
+     * @param 	 radius2 [in], 半径的平方
+     * @param 	 func [in], 访问函数
+     * @param 	 depth [in], 查询深度
+     */
+    void query_radius(Node *node, const PosType& center, double radius2, std::function<void(Node* node)>& func, size_t depth)
+    {
+        const Coord& half_size = half_sizes_[node->depth];
+        double dist2 = 0;
+        for (size_t i = 0; i < DIM; ++i) {
+            double min = to_pos(i, node->center[i] - half_size[i]), max = to_pos(i, node->center[i] + half_size[i]);
+            double d = std::max(min - double(center[i]), std::max(0.0, double(center[i]) - max));
+            dist2 += d * d;
+        }
+        if (dist2 > radius2) return;
+
+        bool leaf = true;
+        if (node->depth < depth) {
+            for (size_t i = 0; i < child_num_; ++i) {
+                if (child(node, i) == nullptr) continue;
+                leaf = false;
+                query_radius(child(node, i), center, radius2, func, depth);
+            }
+        }
+        if (leaf) func(node);
+    }
+
+    /**
+     * @brief 	 [简介] 前序保存子树: 节点数据 + 子节点掩码
+     */
+    void save(std::ostream& os, const Node *node) const
+    {
+        write(os, node->data);
+        uint8_t mask[(child_num_ + 7) / 8] = {0};
+        for (size_t i = 0; i < child_num_; ++i) {
+            if (child(node, i) != nullptr) mask[i / 8] |= uint8_t(1 << (i % 8));
+        }
+        os.write(reinterpret_cast<const char*>(mask), sizeof(mask));
+        for (size_t i = 0; i < child_num_; ++i) {
+            if (child(node, i) != nullptr) save(os, child(node, i));
+        }
+    }
+
+    /**
+     * @brief 	 [简介] 检查镜像中 ref 开始的子树: 引用不越界、不指向空闲位置、不被引用两次, 深度逐层加一
+     * @param 	 valid [in/out], 尚未访问的存活节点, 访问后置为 false
+     */
+    static bool check_image(const NodeArena& arena, uint32_t ref, size_t depth, size_t max_depth, std::vector<bool>& valid)
+    {
+        if (ref >= valid.size() || !valid[ref] || depth >= max_depth) return false;
+        valid[ref] = false;
+        const Node *node = arena.at(ref);
+        if (node->depth != depth) return false;
+        for (size_t i = 0; i < child_num_; ++i) {
+            uint32_t next = node->childs.get(i);
+            if (next != IndexArena<Node>::npos && !check_image(arena, next, depth + 1, max_depth, valid)) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 	 [简介] 前序加载子树
+     */
+    bool load(std::istream& is, Node *node)
+    {
+        read(is, node->data);
+        uint8_t mask[(child_num_ + 7) / 8] = {0};
+        is.read(reinterpret_cast<char*>(mask), sizeof(mask));
+        if (!is) return false;
+        for (size_t i = 0; i < child_num_; ++i) {
+            if (!(mask[i / 8] & (1 << (i % 8)))) continue;
+            if (node->depth + 1 >= max_depth_) return false;
+            Node *next = arena_.create(child_center(node, i), DataType(), node->depth + 1);
+            set_child(node, i, next);
+            if (!load(is, next)) return false;
+        }
+        return true;
+    }
+
+    template <typename T>
+    static void write(std::ostream& os, const T& value) { os.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+    template <typename T>
+    static void read(std::istream& is, T& value) { is.read(reinterpret_cast<char*>(&value), sizeof(T)); }
+
+    /**
+     * @brief 	 [简介] 设置边界, 同时计算内部坐标的变换
+     * @note 	 [注意] 浮点坐标只做类型转换; 定点坐标把边界映射到 [0, 2^30]
+     */
+    void set_boundary(const Boundary& boundary)
+    {
+        boundary_ = boundary;
+        for (size_t i = 0; i < DIM; ++i) {
+            double extent = double(boundary.max[i]) - double(boundary.min[i]);
+            offset_[i] = fixed_point_ ? double(boundary.min[i]) : 0.0;
+            scale_[i] = fixed_point_ && extent > 0 ? double(1 << 30) / extent : 1.0;
+        }
+        Coord min = to_coord(boundary.min), max = to_coord(boundary.max);
+        size_ = max - min;
+        center_ = (max + min) / 2;
+        half_sizes_[0] = size_ / 2;
+        for (size_t d = 1; d < half_sizes_.size(); ++d) half_sizes_[d] = half_sizes_[d - 1] / 2;
+    }
+
+    /**
+     * @brief 	 [简介] PosType -> 内部坐标
+     */
+    Coord to_coord(const PosType& pos) const
+    {
+        Coord coord = center_;
+        for (size_t i = 0; i < DIM; ++i) {
+            coord[i] = to_scalar((double(pos[i]) - offset_[i]) * scale_[i]);
+        }
+        return coord;
+    }
+
+    /**
+     * @brief 	 [简介] 变换后的坐标分量 -> Scalar
+     * @note 	 [注意] 定点坐标先截断到边界 [0, 2^30] 外一个单位再转换, 边界外的查询框不会溢出;
+     *                  多出的一个单位使完全在边界外的查询框仍与边界不相交
+     */
+    static Scalar to_scalar(double value)
+    {
+        if (!fixed_point_) return Scalar(value);
+        value = std::floor(value);
+        return Scalar(value > -1.0 ? std::min(value, double(1 << 30) + 1) : -1.0);
+    }
+
+    /**
+     * @brief 	 [简介] 矩阵第 j 列 -> 内部坐标
+     * @return 	 [true] 点在边界内 or [false] 越界
+     */
+    template <typename Points>
+    bool column_coord(const Points& points, size_t j, Coord& coord) const
+    {
+        bool inside = true;
+        coord = center_;
+        for (size_t i = 0; i < DIM; ++i) {
+            double pos = double(points(i, j));
+            if (pos < double(boundary_.min[i]) || pos > double(boundary_.max[i])) inside = false;
+            coord[i] = to_scalar((pos - offset_[i]) * scale_[i]);
+        }
+        return inside;
+    }
+
+    /**
+     * @brief 	 [简介] 交错批量查找(AMAC): batch_group_ 个查询轮流各下降一层, 每次先预取下一层的子节点,
+     *                   等轮到该查询时子节点已在缓存中, 多个查询的访存延迟互相重叠
+     * @param 	 points [in], DIM 行 N 列的点矩阵
+     * @param 	 depth [in], 查找深度
+     * @param 	 func [in], func(j, node), 第 j 个查询的结果, 调用顺序与 j 无关
+     * @note 	 [注意] 结果与逐点调用 find_coord 相同; 启用哈希索引时每个查询只需几次查表, 直接逐点查找
+     */
+    template <typename Points, typename Func>
+    void find_interleaved(const Points& points, size_t depth, const Func& func)
+    {
+        size_t num = size_t(points.cols());
+        if (hashed_) {
+            for (size_t j = 0; j < num; ++j) {
+                Coord coord;
+                column_coord(points, j, coord);
+                func(j, find_coord(coord, depth));
+            }
+            return;
+        }
+
+        struct Slot
+        {
+            size_t j;
+            Coord coord;
+            Node *node;
+            uint32_t tick;
+        };
+        Slot slots[batch_group_];
+        size_t next = 0, active = 0;
+        auto start = [&](Slot& slot) {
+            if (next == num) return false;
+            slot.j = next++;
+            column_coord(points, slot.j, slot.coord);
+            slot.tick = memory_limit_ != 0 ? ++tick_ : tick_;
+            slot.node = root_;
+            if (dense_levels_ != 0 && depth >= dense_levels_) {
+                Node *node = dense_at(coord_key(slot.coord, dense_levels_));
+                if (node != nullptr) slot.node = node;
+            }
+            __builtin_prefetch(slot.node);
+            return true;
+        };
+        while (active < batch_group_ && start(slots[active])) ++active;
+
+        while (active > 0) {
+            for (size_t s = 0; s < active;) {
+                Slot& slot = slots[s];
+                Node *node = slot.node;
+                touch(node, slot.tick);
+                Node *next_node = node->depth == depth ? nullptr : child(node, find_index(slot.coord, node));
+                if (next_node != nullptr) {
+                    __builtin_prefetch(next_node);
+                    slot.node = next_node;
+                    ++s;
+                    continue;
+                }
+                // 查询结束, 槽位换成新的查询; 没有新查询时用最后一个槽位填补
+                func(slot.j, node);
+                if (start(slot)) ++s;
+                else if (s != --active) slot = slots[active];
+            }
+        }
+    }
+
+    /**
+     * @brief 	 [简介] 递归查找一段已排序的查询, 它们都落在 node 的子树中
+     * @param 	 node [in], 当前节点
+     * @param 	 begin [in], 查询段起点, 第 bottom 层编码
+     * @param 	 end [in], 查询段终点
+     * @param 	 ids [in], 与 begin 对齐的查询下标
+     * @param 	 bottom [in], 查找深度, 不超过 key_levels_
+     * @param 	 nodes [out], 按查询下标写入结果
+     * @note 	 [注意] 编码已排序, 落在同一个子区域的查询是连续的一段, 按子区域id切分后分别下降
+     */
+    void find_sorted(Node *node, const Key *begin, const Key *end, const uint32_t *ids, size_t bottom, Node **nodes)
+    {
+        touch(node, tick_);
+        if (node->depth >= bottom) {
+            for (size_t k = 0; k < size_t(end - begin); ++k) nodes[ids[k]] = node;
+            return;
+        }
+
+        size_t shift = DIM * (bottom - node->depth - 1);
+        while (begin != end) {
+            size_t index = (*begin >> shift) & (child_num_ - 1);
+            const Key *run = begin + 1;
+            while (run != end && ((*run >> shift) & (child_num_ - 1)) == index) ++run;
+
+            Node *next = child(node, index);
+            if (next == nullptr) {
+                for (size_t k = 0; k < size_t(run - begin); ++k) nodes[ids[k]] = node;
+            } else {
+                find_sorted(next, begin, run, ids, bottom, nodes);
+            }
+            ids += run - begin;
+            begin = run;
+        }
+    }
+
+    /**
+     * @brief 	 [简介] 按内部坐标查找, 依次尝试哈希索引、稠密索引和逐层下降
+     */
+    Node *find_coord(const Coord& coord, size_t depth)
+    {
+        if (memory_limit_ != 0) ++tick_;
+        if (hashed_) return find_hashed(coord, depth);
+        if (dense_levels_ != 0 && depth >= dense_levels_) {
+            Node *node = dense_at(coord_key(coord, dense_levels_));
+            if (node != nullptr) return find(node, coord, depth);
+        }
+        return find(root_, coord, depth);
+    }
+
+    /**
+     * @brief 	 [简介] 内部坐标 -> PosType
+     */
+    PosType to_pos(const Coord& coord) const
+    {
+        PosType pos = boundary_.min;
+        for (size_t i = 0; i < DIM; ++i) pos[i] = to_pos(i, coord[i]);
+        return pos;
+    }
+
+    double to_pos(size_t i, Scalar value) const { return double(value) / scale_[i] + offset_[i]; }
+
+    /**
+     * @brief 	 [简介] 计算内部坐标在指定深度所在节点的编码
+     * @note 	 [注意] 编码最多容纳 key_levels_ 层, 更深的 depth 按 key_levels_ 计算
+     */
+    Key coord_key(const Coord& pos, size_t depth) const
+    {
+        depth = std::min(depth, size_t(key_levels_));
+        Key key = 0;
+        // 在局部标量数组上计算, 中心的移动用乘法代替分支, 随机的点不会产生分支预测失败
+        Scalar p[DIM], center[DIM];
+        for (size_t i = 0; i < DIM; ++i) {
+            p[i] = pos[i];
+            center[i] = center_[i];
+        }
+        for (size_t d = 0; d < depth; ++d) {
+            const Coord& half_size = half_sizes_[d + 1];
+            size_t index = 0;
+            for (size_t i = 0; i < DIM; ++i) {
+                bool upper = p[i] > center[i];
+                index |= size_t(upper) << i;
+                center[i] += Scalar(2 * int(upper) - 1) * half_size[i];
+            }
+            key = (key << DIM) | index;
+        }
+        return key;
+    }
+
+    /**
+     * @brief 	 [简介] 判断两棵树的边界和深度是否相同
+     */
+    bool same_layout(const Octree& other) const
+    {
+        if (max_depth_ != other.max_depth_) return false;
+        for (size_t i = 0; i < DIM; ++i) {
+            if (boundary_.min[i] != other.boundary_.min[i] || boundary_.max[i] != other.boundary_.max[i]) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 	 [简介] 递归合并两个对应节点的子节点
+     * @param 	 dst [in], 本树节点
+     * @param 	 src [in], other 中的对应节点, 合并完后由调用者回收
+     */
+    template <typename Policy>
+    void merge(Node *dst, Node *src, Policy& policy)
+    {
+        for (size_t i = 0; i < child_num_; ++i) {
+            Node *src_child = child(src, i);
+            if (src_child == nullptr) continue;
+            set_child(src, i, nullptr);
+
+            Node *dst_child = child(dst, i);
+            if (dst_child == nullptr) {
+                set_child(dst, i, src_child);
+                mark_subtree(src_child);
+                continue;
+            }
+            dst_child->data = policy(dst_child->data, src_child->data);
+            dst_child->version = version_;
+            merge(dst_child, src_child, policy);
+            arena_.destroy(src_child);
+        }
+    }
+
+    /**
+     * @brief 	 [简介] 递归比较两个对应节点
+     * @param 	 other [in], 目标树
+     * @param 	 a [in], 本树节点
+     * @param 	 b [in], 目标树节点
+     * @param 	 path [in], 节点路径, 递归时逐层压入和弹出
+     * @param 	 diffs [out], 差异
+     */
+    void diff(const Octree& other, const Node *a, const Node *b, std::vector<uint32_t>& path, std::vector<NodeDiff>& diffs) const
+    {
+        if (!(a->data == b->data)) diffs.push_back(NodeDiff{DiffType::CHANGED, path, b->data});
+        for (size_t i = 0; i < child_num_; ++i) {
+            const Node *a_child = child(a, i);
+            const Node *b_child = other.child(b, i);
+            if (a_child == nullptr && b_child == nullptr) continue;
+
+            path.push_back(uint32_t(i));
+            if (b_child == nullptr) {
+                diffs.push_back(NodeDiff{DiffType::REMOVED, path, a_child->data});
+            } else if (a_child == nullptr) {
+                other.added(b_child, path, diffs);
+            } else {
+                diff(other, a_child, b_child, path, diffs);
+            }
+            path.pop_back();
+        }
+    }
+
+    /**
+     * @brief 	 [简介] 把只存在于目标树(本树)中的子树全部记为新增
+     */
+    void added(const Node *node, std::vector<uint32_t>& path, std::vector<NodeDiff>& diffs) const
+    {
+        diffs.push_back(NodeDiff{DiffType::ADDED, path, node->data});
+        for (size_t i = 0; i < child_num_; ++i) {
+            if (child(node, i) == nullptr) continue;
+            path.push_back(uint32_t(i));
+            added(child(node, i), path, diffs);
+            path.pop_back();
+        }
+    }
+
+    /**
+     * @brief 	 [简介] 找出所有满子树(直到叶子层的每个区域都存在)
+     * @param 	 node [in], 子树根节点
+     * @param 	 full [out], 满子树的根节点集合
+     * @return 	 [true] node 是满子树 or [false]
+     */
+    bool find_full(const Node *node, std::unordered_set<const Node*>& full) const
+    {
+        bool is_full = true;
+        if (node->depth + 1 < max_depth_) {
+            for (size_t i = 0; i < child_num_; ++i) {
+                if (child(node, i) == nullptr) is_full = false;
+                else if (!find_full(child(node, i), full)) is_full = false;
+            }
+        }
+        if (is_full) full.insert(node);
+        return is_full;
+    }
+
+    /**
+     * @brief 	 [简介] 对两个对应节点做集合运算
+     * @param 	 ta [in], 左操作数
+     * @param 	 a [in], 左操作数节点, 可为空
+     * @param 	 tb [in], 右操作数
+     * @param 	 b [in], 右操作数节点, 可为空
+     * @param 	 op [in], 运算类型
+     * @param 	 full [in], 满子树集合(并集时为 a 的, 否则为 b 的)
+     * @param 	 arena [in], 结果节点的内存池
+     * @return 	 [Node*] 返回结果节点, 结果为空时返回 nullptr
+     */
+    Node *combine(const Octree& ta, const Node *a, const Octree& tb, const Node *b, SetOp op,
+                  const std::unordered_set<const Node*>& full, NodeArena& arena)
+    {
+        switch (op) {
+        case SetOp::UNION:
+            if (b == nullptr || (a != nullptr && full.count(a))) return a ? copy_subtree(ta, a, arena) : nullptr;
+            if (a == nullptr) return copy_subtree(tb, b, arena);
+            break;
+        case SetOp::INTERSECTION:
+            if (a == nullptr || b == nullptr) return nullptr;
+            if (full.count(b)) return copy_subtree(ta, a, arena);
+            break;
+        case SetOp::DIFFERENCE:
+            if (a == nullptr || (b != nullptr && full.count(b))) return nullptr;
+            if (b == nullptr) return copy_subtree(ta, a, arena);
+            break;
+        }
+
+        // 两边都存在且都不能直接决定结果
+        Node *node = arena.create(a->center, a->data, a->depth);
+        if (a->depth + 1 >= ta.max_depth_) {
+            if (op == SetOp::DIFFERENCE) {
+                arena.destroy(node);
+                return nullptr;
+            }
+            return node;
+        }
+
+        bool empty = true;
+        node->data = DataType();
+        for (size_t i = 0; i < child_num_; ++i) {
+            Node *result = combine(ta, ta.child(a, i), tb, tb.child(b, i), op, full, arena);
+            if (result == nullptr) continue;
+            node->childs.set(i, RefPolicy::ref(arena, result));
+            node->data = update(node->data, result->data);
+            empty = false;
+        }
+        if (empty) {
+            arena.destroy(node);
+            return nullptr;
+        }
+        return node;
+    }
+
+    /**
+     * @brief 	 [简介] 用另一棵树的深拷贝替换本树的内容
+     * @param 	 other [in], 源树
+     * @note 	 [注意] 根节点的每个子树作为共享线程池中的一个任务拷贝到各自的内存池, 最后拼接到本树的内存池中
+     */
+    void copy_from(const Octree& other)
+    {
+        if (this == &other) return;
+        release();
+        set_boundary(other.boundary_);
+        max_depth_ = other.max_depth_;
+        memory_limit_ = other.memory_limit_;
+        version_ = other.version_;
+        dense_levels_ = other.dense_levels_;
+        hashed_ = other.hashed_;
+        root_ = arena_.create(*other.root_);
+        for (size_t i = 0; i < child_num_; ++i) set_child(root_, i, nullptr);
+
+        NodeArena arenas[child_num_];
+        Node *copies[child_num_] = {nullptr};
+        TaskGroup group;
+        for (size_t i = 0; i < child_num_; ++i) {
+            const Node *child = other.child(other.root_, i);
+            if (child == nullptr) continue;
+            NodeArena *arena = &arenas[i];
+            Node **dst = &copies[i];
+            group.spawn([&other, child, arena, dst]() { *dst = copy_subtree(other, child, *arena); });
+        }
+        group.sync();
+        for (size_t i = 0; i < child_num_; ++i) {
+            if (copies[i] == nullptr) continue;
+            rebase(copies[i], arena_.splice(arenas[i]));
+            set_child(root_, i, copies[i]);
+        }
+    }
+
+    /**
+     * @brief 	 [简介] 递归拷贝子树
+     * @param 	 tree [in], 源节点所在的树
+     * @param 	 node [in], 源节点
+     * @param 	 arena [in], 目标内存池
+     * @return 	 [Node*] 返回拷贝出的节点
+     */
+    static Node *copy_subtree(const Octree& tree, const Node *node, NodeArena& arena)
+    {
+        Node *copy = arena.create(*node);
+        for (size_t i = 0; i < child_num_; ++i) {
+            Node *child = tree.child(node, i);
+            copy->childs.set(i, RefPolicy::ref(arena, child == nullptr ? nullptr : copy_subtree(tree, child, arena)));
+        }
+        return copy;
+    }
+
+    /**
+     * @brief 	 [简介] 子树中子节点表在堆上占用的内存(字节)
+     */
+    size_t heap_bytes(const Node *node) const
+    {
+        size_t bytes = node->childs.heap_bytes();
+        for (size_t i = 0; i < child_num_; ++i) {
+            if (child(node, i) != nullptr) bytes += heap_bytes(child(node, i));
+        }
+        return bytes;
+    }
+
+    /**
+     * @brief 	 [简介] 设置子节点
+     * @param 	 node [in], 父节点
+     * @param 	 index [in], 子区域id
+     * @param 	 child [in], 子节点, 必须来自本树的内存池, 可为 nullptr
+     */
+    void set_child(Node *node, size_t index, Node *child) { node->childs.set(index, RefPolicy::ref(arena_, child)); }
+
+    /**
+     * @brief 	 [简介] 被 splice 进本树内存池的子树, 其中的子节点引用加上下标偏移
+     * @param 	 node [in], 子树根节点
+     * @param 	 offset [in], splice 返回的偏移, 指针引用时为 0
+     */
+    void rebase(Node *node, size_t offset)
+    {
+        if (offset == 0) return;
+        for (size_t i = 0; i < child_num_; ++i) {
+            node->childs.set(i, RefPolicy::template rebase<Node>(node->childs.get(i), offset));
+            if (child(node, i) != nullptr) rebase(child(node, i), offset);
+        }
+    }
+
+    /**
+     * @brief 	 [简介] 析构子树中的所有节点, 内存留在内存池中复用
+     * @param 	 node [in], 子树根节点
+     */
+    void clear(Node *node)
+    {
+        if (node == nullptr) return;
+        for (size_t i = 0; i < child_num_; ++i) clear(child(node, i));
+        arena_.destroy(node);
+    }
+
+    /**
+     * @brief 	 [简介] 释放整棵树和内存池, 节点可平凡析构时直接归还内存块
+     */
+    void release()
+    {
+        if (!std::is_trivially_destructible<Node>::value) clear(root_);
+        arena_.release();
+        root_ = nullptr;
+        index_valid_ = false;
+    }
+
+    /**
+     * @brief 	 [简介] 按稠密层的编码取节点, 索引失效时先重建
+     * @return 	 [Node*] 返回第 dense_levels_ 层的节点, 不存在时返回 nullptr
+     */
+    Node *dense_at(Key key)
+    {
+        if (!index_valid_) rebuild_index();
+        return dense_[key];
+    }
+
+    /**
+     * @brief 	 [简介] 用哈希索引查找: 路径上存在的节点是从根开始的连续前缀, 在层之间二分找最深的一个
+     * @note 	 [注意] 到达 hash_levels_ 层后按坐标继续下降
+     */
+    Node *find_hashed(const Coord& pos, size_t depth)
+    {
+        if (!index_valid_) rebuild_index();
+        size_t limit = std::min(depth, max_depth_ == 0 ? 0 : max_depth_ - 1);
+        size_t lo = 0, hi = std::min(limit, size_t(hash_levels_)), bottom = hi;
+        Key key = coord_key(pos, bottom);
+        Node *node = root_;
+        while (lo < hi) {
+            size_t mid = (lo + hi + 1) / 2;
+            Node *found = table_.find(location(key >> (DIM * (bottom - mid)), mid));
+            if (found == nullptr) {
+                hi = mid - 1;
+            } else {
+                lo = mid;
+                node = found;
+            }
+        }
+        if (node->depth == bottom && limit > bottom) return find(node, pos, depth);
+        touch(node, tick_);
+        return node;
+    }
+
+    /**
+     * @brief 	 [简介] 重建稠密层索引和哈希索引, 代价与被索引的节点数成正比
+     */
+    void rebuild_index()
+    {
+        dense_.assign(size_t(1) << (DIM * dense_levels_), nullptr);
+        table_.clear();
+        if (hashed_) table_.reserve(arena_.size());
+        if (root_ != nullptr) index_subtree(root_, 0);
+        index_valid_ = true;
+    }
+
+    /**
+     * @brief 	 [简介] 位置码: 在编码前加一个标志位, 使不同深度的编码互不相同且不为 0
+     */
+    static Key location(Key key, size_t depth) { return (Key(1) << (DIM * depth)) | key; }
+
+    void index_subtree(Node *node, Key key)
+    {
+        if (hashed_) table_.insert(location(key, node->depth), node);
+        if (node->depth == dense_levels_) {
+            dense_[key] = node;
+            if (!hashed_) return;
+        }
+        if (node->depth == hash_levels_) return;
+        for (size_t i = 0; i < child_num_; ++i) {
+            if (child(node, i) != nullptr) index_subtree(child(node, i), (key << DIM) | i);
+        }
+    }
+private:
+    /**
+     * @brief 	 [简介] 位置码 -> 节点 的哈希表, 开放寻址、线性探测
+     * @note 	 [注意] 只插入不删除, 树结构被修改后整体重建
+     */
+    class NodeTable {
+    public:
+        Node *find(Key code) const
+        {
+            if (slots_.empty()) return nullptr;
+            size_t mask = slots_.size() - 1;
+            for (size_t i = hash(code) & mask; ; i = (i + 1) & mask) {
+                if (slots_[i].first == code) return slots_[i].second;
+                if (slots_[i].first == 0) return nullptr;
+            }
+        }
+
+        void insert(Key code, Node *node)
+        {
+            if ((size_ + 1) * 2 > slots_.size()) reserve(size_ + 1);
+            size_t mask = slots_.size() - 1;
+            size_t i = hash(code) & mask;
+            while (slots_[i].first != 0 && slots_[i].first != code) i = (i + 1) & mask;
+            if (slots_[i].first == 0) ++size_;
+            slots_[i] = std::make_pair(code, node);
+        }
+
+        /**
+         * @brief 	 [简介] 预留空间, 负载因子不超过 1/2
+         */
+        void reserve(size_t num)
+        {
+            size_t capacity = 16;
+            while (capacity < num * 2) capacity *= 2;
+            if (capacity <= slots_.size()) return;
+            std::vector<std::pair<Key, Node*>> slots(capacity, std::make_pair(Key(0), static_cast<Node*>(nullptr)));
+            slots.swap(slots_);
+            size_ = 0;
+            for (const auto& slot : slots) {
+                if (slot.first != 0) insert(slot.first, slot.second);
+            }
+        }
+
+        void clear()
+        {
+            slots_.clear();
+            size_ = 0;
+        }
+    private:
+        static size_t hash(Key code)
+        {
+            code *= 0x9e3779b97f4a7c15ull;
+            return size_t(code ^ (code >> 32));
+        }
+    private:
+        std::vector<std::pair<Key, Node*>> slots_;
+        size_t size_ = 0;
+    };
+
+    /**
+     * @brief 	 [简介] 找到点所在的区域
+     * @param 	 pos [in], 点位置
+     * @param 	 node [in], 所在节点
+     * @return 	 [size_t] 返回点所在区域的id
+    */
+    size_t find_index(const Coord& pos, const Node *node) { return VecKernel<Coord, DIM>::find_index(pos, node->center); }
+
+    /**
+     * @brief 	 [简介] 找到点所在区域的中心
+     * @param 	 pos [in], 点位置 
+     * @param 	 node [in], 所在节点
+     * @return 	 [Coord] 返回点所在区域的中心
+     */
+    Coord find_center(const Coord& pos, const Node *node)
+    {
+        Coord center = node->center;
+        const Coord& half_size = half_sizes_[node->depth + 1];
+        for (size_t i = 0; i < DIM; ++i) {
+            center[i] = (pos[i] > node->center[i]) ? center[i] + half_size[i] : center[i] - half_size[i];
+        }
+
+        return center;
+    }
+
+    /**
+     * @brief 	 [简介] 找到子区域的中心
+     * @param 	 node [in], 父节点
+     * @param 	 index [in], 子区域id
+     * @return 	 [Coord] 返回子区域的中心
+     */
+    Coord child_center(const Node *node, size_t index) const
+    {
+        Coord center = node->center;
+        const Coord& half_size = half_sizes_[node->depth + 1];
+        for (size_t i = 0; i < DIM; ++i) {
+            center[i] = (index & (1 << i)) ? center[i] + half_size[i] : center[i] - half_size[i];
+        }
+        return center;
+    }
+    /**
+     * @brief 	 [简介] export_image 的镜像头部, 之后是空闲下标和节点
+     */
+    struct ImageHeader
+    {
+        uint32_t magic;
+        uint32_t dim;
+        uint32_t node_bytes;    // sizeof(Node), 类型或平台不同时拒绝
+        uint32_t max_depth;
+        uint32_t root;          // 根节点下标
+        uint32_t version;
+        uint64_t capacity;      // 节点个数(含空闲位置)
+        uint64_t free_num;
+        double min[DIM];
+        double max[DIM];
+    };
+    constexpr static uint32_t image_magic_ = 0x4d494f54;    // "TOIM"
+protected:
+    Boundary boundary_;
+    std::array<double, DIM> offset_;    // 内部坐标 = (pos - offset_) * scale_
+    std::array<double, DIM> scale_;
+    Coord size_;                        // 内部坐标下的边界尺寸
+    Coord center_;                      // 内部坐标下的边界中心
+    std::array<Coord, 64 + 2> half_sizes_;  // 每层节点的半尺寸, 下降时查表, 不做除法; 覆盖 max_depth_limit_ 和编码的 key_levels_ 层
+    size_t max_depth_;
+    size_t memory_limit_;
+    uint32_t tick_;         // 访问时钟, 溢出后只会让合并顺序暂时不准
+    uint32_t version_;      // 当前版本号
+    size_t dense_levels_;
+    bool hashed_;
+    bool index_valid_;      // 索引与树结构一致; 插入会维护索引, 其他结构修改使其失效
+    std::vector<Node*> dense_;
+    NodeTable table_;       // 哈希索引, 键为位置码
+    NodeArena arena_;
+    Node *root_;
 };
 
+/**
+ * @brief 	 [简介] 合并两棵树, b 中不与 a 重叠的子树直接嫁接到 a 上
+ * @param 	 a [in], 树 a
+ * @param 	 b [in], 树 b
+ * @param 	 policy [in], 数据合并方法, 默认相加
+ * @return 	 [Octree] 返回合并后的树; 边界或深度不同时返回 a
+ */
+template <typename PosType, typename DataType, size_t DIM, typename RefPolicy, typename Coord, typename Policy = std::plus<DataType>>
+Octree<PosType, DataType, DIM, RefPolicy, Coord> merge(Octree<PosType, DataType, DIM, RefPolicy, Coord>&& a,
+                                                       Octree<PosType, DataType, DIM, RefPolicy, Coord>&& b, Policy policy = Policy())
+{
+    a.merge(std::move(b), policy);
+    return std::move(a);
+}
+
+/**
+ * @brief 	 [简介] 计算从 a 到 b 的差异, 只包含变化的节点, 可用于在机器人之间传输增量
+ */
+template <typename PosType, typename DataType, size_t DIM, typename RefPolicy, typename Coord>
+std::vector<typename Octree<PosType, DataType, DIM, RefPolicy, Coord>::NodeDiff> diff(const Octree<PosType, DataType, DIM, RefPolicy, Coord>& a,
+                                                                                      const Octree<PosType, DataType, DIM, RefPolicy, Coord>& b)
+{
+    return a.diff(b);
+}
+
+/**
+ * @brief 	 [简介] 占据树的并集/交集/差集, 例如 "已知障碍物 - 动态物体掩膜"
+ * @return 	 [Octree] 返回新树; 边界或深度不同时返回与 a 相同边界的空树
+ */
+template <typename PosType, typename DataType, size_t DIM, typename RefPolicy, typename Coord>
+Octree<PosType, DataType, DIM, RefPolicy, Coord> unite(const Octree<PosType, DataType, DIM, RefPolicy, Coord>& a,
+                                                       const Octree<PosType, DataType, DIM, RefPolicy, Coord>& b)
+{
+    Octree<PosType, DataType, DIM, RefPolicy, Coord> tree(a.boundary().min, a.boundary().max, a.max_depth());
+    tree.set_operation(a, b, Octree<PosType, DataType, DIM, RefPolicy, Coord>::SetOp::UNION);
+    return tree;
+}
+
+template <typename PosType, typename DataType, size_t DIM, typename RefPolicy, typename Coord>
+Octree<PosType, DataType, DIM, RefPolicy, Coord> intersect(const Octree<PosType, DataType, DIM, RefPolicy, Coord>& a,
+                                                           const Octree<PosType, DataType, DIM, RefPolicy, Coord>& b)
+{
+    Octree<PosType, DataType, DIM, RefPolicy, Coord> tree(a.boundary().min, a.boundary().max, a.max_depth());
+    tree.set_operation(a, b, Octree<PosType, DataType, DIM, RefPolicy, Coord>::SetOp::INTERSECTION);
+    return tree;
+}
+
+template <typename PosType, typename DataType, size_t DIM, typename RefPolicy, typename Coord>
+Octree<PosType, DataType, DIM, RefPolicy, Coord> subtract(const Octree<PosType, DataType, DIM, RefPolicy, Coord>& a,
+                                                          const Octree<PosType, DataType, DIM, RefPolicy, Coord>& b)
+{
+    Octree<PosType, DataType, DIM, RefPolicy, Coord> tree(a.boundary().min, a.boundary().max, a.max_depth());
+    tree.set_operation(a, b, Octree<PosType, DataType, DIM, RefPolicy, Coord>::SetOp::DIFFERENCE);
+    return tree;
+}
+
 template<typename PosType, typename DataType> using QuadTree = Octree<PosType, DataType, 2>;
 template<typename PosType, typename DataType> using OctTree = Octree<PosType, DataType, 3>;
 
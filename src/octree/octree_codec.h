@@ -0,0 +1,298 @@
+/**
+ * Copyright (C), 2023
+ * @file 	 octree_codec.h
+ * @author 	 peitianyu(https://github.com/peitianyu)
+ * @date 	 2026-10-17
+ * @brief 	 [简介] 紧凑的树结构码流: 按层序写出子节点掩码, 可选量化的节点数据, 用于进程间传输和记录日志
+ */
+#ifndef __OCTREE_CODEC_H__
+#define __OCTREE_CODEC_H__
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "octree/octree.h"
+
+/**
+ * @brief 	 [简介] 树的编码器/解码器
+ * @note 	 [注意] 码流格式: 头 + 层序(BFS)排列的子节点掩码(每个节点 child_num_ 位, 八叉树为 1 字节)
+ *                  + 层序排列的节点数据; 最深一层的节点没有掩码, 节点中心在解码时重新计算
+ */
+template <typename PosType, typename DataType, size_t DIM, typename RefPolicy, typename Coord>
+class OctreeCodec {
+public:
+    using Tree = Octree<PosType, DataType, DIM, RefPolicy, Coord>;
+    using Node = typename Tree::Node;
+    using Boundary = typename Tree::Boundary;
+    constexpr static size_t child_num_ = Tree::child_num_;
+
+    enum class Payload : uint8_t { NONE, RAW, QUANTIZED8, QUANTIZED16 };
+
+    struct Options
+    {
+        Payload payload = Payload::RAW;
+        size_t depth = 0;           // 编码深度, 0 表示编码到叶子
+        bool use_region = false;    // 只编码与 region 相交的节点
+        Boundary region;
+    };
+
+    /**
+     * @brief 	 [简介] 编码
+     * @param 	 tree [in], 源树
+     * @param 	 options [in], 编码选项
+     * @return 	 [std::vector<uint8_t>] 返回码流, DataType 不支持所选的数据编码方式时返回空(解码失败)
+     * @note 	 [注意] RAW 要求 DataType 可按字节拷贝, QUANTIZED 要求 DataType 为算术类型, 见 supports
+     */
+    static std::vector<uint8_t> encode(const Tree& tree, const Options& options = Options())
+    {
+        if (!supports(options.payload)) return std::vector<uint8_t>();
+        size_t depth = tree.max_depth() == 0 ? 0 : tree.max_depth() - 1;
+        if (options.depth != 0 && options.depth < depth) depth = options.depth;
+
+        // 层序遍历, 最深一层不写掩码
+        std::vector<const Node*> order(1, tree.root());
+        BitWriter masks;
+        for (size_t cur = 0; cur < order.size(); ++cur) {
+            const Node *node = order[cur];
+            if (node->depth >= depth) continue;
+            for (size_t i = 0; i < child_num_; ++i) {
+                const Node *child = tree.child(node, i);
+                bool keep = child != nullptr && (!options.use_region || overlap(tree, child, options.region));
+                masks.put(keep);
+                if (keep) order.push_back(child);
+            }
+        }
+
+        std::vector<uint8_t> stream;
+        put(stream, uint32_t(magic_));
+        put(stream, uint8_t(DIM));
+        put(stream, uint8_t(options.payload));
+        put(stream, uint32_t(tree.max_depth()));
+        put(stream, uint32_t(depth));
+        for (size_t i = 0; i < DIM; ++i) {
+            put(stream, double(tree.boundary().min[i]));
+            put(stream, double(tree.boundary().max[i]));
+        }
+        put(stream, uint64_t(order.size()));
+        stream.insert(stream.end(), masks.bytes.begin(), masks.bytes.end());
+
+        write_payload(stream, order, options.payload);
+        return stream;
+    }
+
+    /**
+     * @brief 	 [简介] 解码, 结果替换 tree 的内容
+     * @param 	 stream [in], 码流
+     * @param 	 tree [out], 解码出的树
+     * @return 	 [true] 成功 or [false] 码流不完整或不匹配
+     */
+    static bool decode(const std::vector<uint8_t>& stream, Tree& tree)
+    {
+        size_t offset = 0;
+        uint32_t magic = 0, max_depth = 0, depth = 0;
+        uint8_t dim = 0, payload = 0;
+        uint64_t count = 0;
+        if (!get(stream, offset, magic) || magic != magic_) return false;
+        if (!get(stream, offset, dim) || dim != DIM) return false;
+        if (!get(stream, offset, payload) || !get(stream, offset, max_depth) || !get(stream, offset, depth)) return false;
+        // 深度来自码流, 超出半尺寸表或节点比最大深度更深时拒绝
+        if (max_depth > Tree::max_depth_limit_ || depth >= std::max<uint32_t>(max_depth, 1)) return false;
+        if (payload > uint8_t(Payload::QUANTIZED16) || !supports(Payload(payload))) return false;
+
+        PosType min = tree.boundary().min, max = tree.boundary().max;
+        for (size_t i = 0; i < DIM; ++i) {
+            double lo = 0, hi = 0;
+            if (!get(stream, offset, lo) || !get(stream, offset, hi)) return false;
+            min[i] = lo;
+            max[i] = hi;
+        }
+        if (!get(stream, offset, count)) return false;
+
+        Tree decoded(min, max, max_depth);
+        std::vector<Node*> order(1, decoded.root_);
+        order.reserve(std::min<uint64_t>(count, stream.size() * 8));
+        BitReader masks(stream, offset);
+        for (size_t cur = 0; cur < order.size(); ++cur) {
+            Node *node = order[cur];
+            if (node->depth >= depth) continue;
+            for (size_t i = 0; i < child_num_; ++i) {
+                bool bit = false;
+                if (!masks.get(bit)) return false;
+                if (!bit) continue;
+                Node *child = decoded.arena_.create(decoded.child_center(node, i), DataType(), node->depth + 1);
+                decoded.set_child(node, i, child);
+                order.push_back(child);
+            }
+        }
+        if (order.size() != count) return false;
+        offset = masks.end();
+
+        if (!read_payload(stream, offset, order, Payload(payload))) return false;
+        decoded.mark_subtree(decoded.root_);
+        tree = std::move(decoded);
+        return true;
+    }
+    /**
+     * @brief 	 [简介] DataType 是否支持该数据编码方式: RAW 要求可按字节拷贝, QUANTIZED 要求为算术类型
+     */
+    static bool supports(Payload payload)
+    {
+        switch (payload) {
+        case Payload::NONE:
+            return true;
+        case Payload::RAW:
+            return std::is_trivially_copyable<DataType>::value;
+        case Payload::QUANTIZED8:
+        case Payload::QUANTIZED16:
+            return std::is_arithmetic<DataType>::value;
+        }
+        return false;
+    }
+private:
+    constexpr static uint32_t magic_ = 0x4254434f;     // "OCTB"
+
+    struct BitWriter
+    {
+        std::vector<uint8_t> bytes;
+        size_t bits = 0;
+
+        void put(bool bit)
+        {
+            if (bits % 8 == 0) bytes.push_back(0);
+            if (bit) bytes.back() |= uint8_t(1 << (bits % 8));
+            ++bits;
+        }
+    };
+
+    struct BitReader
+    {
+        const std::vector<uint8_t>& bytes;
+        size_t begin;
+        size_t bits;
+
+        BitReader(const std::vector<uint8_t>& bytes, size_t begin) : bytes(bytes), begin(begin), bits(0) { }
+
+        bool get(bool& bit)
+        {
+            size_t byte = begin + bits / 8;
+            if (byte >= bytes.size()) return false;
+            bit = (bytes[byte] >> (bits % 8)) & 1;
+            ++bits;
+            return true;
+        }
+
+        size_t end() const { return begin + (bits + 7) / 8; }
+    };
+
+    static bool overlap(const Tree& tree, const Node *node, const Boundary& region)
+    {
+        Boundary boundary;
+        tree.find_boundary(node, boundary);
+        for (size_t i = 0; i < DIM; ++i) {
+            if (boundary.min[i] > region.max[i] || boundary.max[i] < region.min[i]) return false;
+        }
+        return true;
+    }
+
+    template <typename T>
+    static void put(std::vector<uint8_t>& stream, const T& value)
+    {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t*>(&value);
+        stream.insert(stream.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    static bool get(const std::vector<uint8_t>& stream, size_t& offset, T& value)
+    {
+        if (offset + sizeof(T) > stream.size()) return false;
+        std::memcpy(&value, stream.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    /**
+     * @brief 	 [简介] 写出节点数据, 量化时先写出数据范围
+     */
+    static void write_payload(std::vector<uint8_t>& stream, const std::vector<const Node*>& order, Payload payload)
+    {
+        switch (payload) {
+        case Payload::NONE:
+            break;
+        case Payload::RAW:
+            for (const Node *node : order) put_raw(stream, node->data, std::is_trivially_copyable<DataType>());
+            break;
+        case Payload::QUANTIZED8:
+        case Payload::QUANTIZED16: {
+            double lo = 0, hi = 0;
+            for (size_t i = 0; i < order.size(); ++i) {
+                double value = to_double(order[i]->data, std::is_arithmetic<DataType>());
+                lo = i == 0 ? value : std::min(lo, value);
+                hi = i == 0 ? value : std::max(hi, value);
+            }
+            put(stream, lo);
+            put(stream, hi);
+            double levels = payload == Payload::QUANTIZED8 ? 255.0 : 65535.0;
+            double scale = hi > lo ? levels / (hi - lo) : 0.0;
+            for (const Node *node : order) {
+                double q = std::round((to_double(node->data, std::is_arithmetic<DataType>()) - lo) * scale);
+                if (payload == Payload::QUANTIZED8) put(stream, uint8_t(q));
+                else put(stream, uint16_t(q));
+            }
+            break;
+        }
+        }
+    }
+
+    static bool read_payload(const std::vector<uint8_t>& stream, size_t& offset, const std::vector<Node*>& order, Payload payload)
+    {
+        switch (payload) {
+        case Payload::NONE:
+            return true;
+        case Payload::RAW:
+            for (Node *node : order) {
+                if (!get_raw(stream, offset, node->data, std::is_trivially_copyable<DataType>())) return false;
+            }
+            return true;
+        case Payload::QUANTIZED8:
+        case Payload::QUANTIZED16: {
+            double lo = 0, hi = 0;
+            if (!get(stream, offset, lo) || !get(stream, offset, hi)) return false;
+            double levels = payload == Payload::QUANTIZED8 ? 255.0 : 65535.0;
+            double step = (hi - lo) / levels;
+            for (Node *node : order) {
+                double q = 0;
+                if (payload == Payload::QUANTIZED8) {
+                    uint8_t value = 0;
+                    if (!get(stream, offset, value)) return false;
+                    q = value;
+                } else {
+                    uint16_t value = 0;
+                    if (!get(stream, offset, value)) return false;
+                    q = value;
+                }
+                from_double(lo + q * step, node->data, std::is_arithmetic<DataType>());
+            }
+            return true;
+        }
+        }
+        return false;
+    }
+
+    // 按 DataType 的类型分派, 不支持的分支只为通过编译, encode/decode 已用 supports 拒绝
+    static void put_raw(std::vector<uint8_t>& stream, const DataType& data, std::true_type) { put(stream, data); }
+    static void put_raw(std::vector<uint8_t>&, const DataType&, std::false_type) { }
+    static bool get_raw(const std::vector<uint8_t>& stream, size_t& offset, DataType& data, std::true_type) { return get(stream, offset, data); }
+    static bool get_raw(const std::vector<uint8_t>&, size_t&, DataType&, std::false_type) { return false; }
+    static double to_double(const DataType& data, std::true_type) { return double(data); }
+    static double to_double(const DataType&, std::false_type) { return 0.0; }
+    static void from_double(double value, DataType& data, std::true_type)
+    {
+        data = std::is_integral<DataType>::value ? DataType(std::round(value)) : DataType(value);
+    }
+    static void from_double(double, DataType&, std::false_type) { }
+};
+
+#endif // __OCTREE_CODEC_H__
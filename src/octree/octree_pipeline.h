@@ -0,0 +1,196 @@
+/**
+ * Copyright (C), 2023
+ * @file 	 octree_pipeline.h
+ * @author 	 peitianyu(https://github.com/peitianyu)
+ * @date 	 2026-10-17
+ * @brief 	 [简介] 后台建图流水线: 生产者无锁入队, 建图线程批量插入, 定期发布只读副本
+ */
+#ifndef __OCTREE_PIPELINE_H__
+#define __OCTREE_PIPELINE_H__
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include "core/tt_mpsc_queue.h"
+#include "octree/octree.h"
+#include "octree/linear_octree.h"
+
+/**
+ * @brief 	 [简介] 建图流水线, 独占可写的 Octree
+ * @note 	 [注意] 传感器回调只调用 push, 写入预先分配的环形队列, 不分配内存也不会因为地图维护而阻塞, 队列满时丢弃该点;
+ *                  读线程通过 snapshot 拿到不可变副本, 副本以原子方式替换(双缓冲), 旧副本在最后一个读者释放后销毁;
+ *                  每次发布都重新展开整棵树, 代价为 O(N); 两次发布之间的间隔不少于上一次发布的耗时,
+ *                  树变大后发布自动变稀, 建图线程最多一半的时间用于发布;
+ *                  Coord 为可写树的内部坐标类型, 副本中的节点中心总是 PosType
+ */
+template <typename PosType, typename DataType, size_t DIM, typename Coord = PosType>
+class OctreePipeline {
+public:
+    using Tree = Octree<PosType, DataType, DIM, PointerRef, Coord>;
+    using Snapshot = LinearOctree<PosType, DataType, DIM>;
+
+    /**
+     * @brief 	 [简介] 构造函数, 同时启动建图线程
+     * @param 	 min [in], 边界最小值
+     * @param 	 max [in], 边界最大值
+     * @param 	 depth [in], 最大深度
+     * @param 	 batch_size [in], 每批最多插入的点数
+     * @param 	 publish_ms [in], 发布副本的周期(毫秒), 树较大时实际间隔受发布耗时限制
+     * @param 	 queue_capacity [in], 待插入点队列的容量
+     */
+    OctreePipeline(const PosType& min, const PosType& max, size_t depth,
+                   size_t batch_size = 4096, size_t publish_ms = 100, size_t queue_capacity = 1 << 16)
+        : queue_(queue_capacity), tree_(min, max, depth), batch_size_(batch_size), publish_period_(publish_ms),
+          snapshot_(std::allocate_shared<Snapshot>(AlignedAllocator<Snapshot>(), tree_)),
+          pushed_(0), dropped_(0), published_(0), publish_request_(false), running_(true), finished_(false)
+    {
+        builder_ = std::thread(&OctreePipeline::run, this);
+    }
+
+    /**
+     * @brief 	 [简介] 析构函数, 处理完剩余的点后停止建图线程
+     */
+    ~OctreePipeline() { stop(); }
+
+    OctreePipeline(const OctreePipeline&) = delete;
+    OctreePipeline& operator=(const OctreePipeline&) = delete;
+
+    /**
+     * @brief 	 [简介] 提交一个点, 任意线程可调用, 无锁且不分配内存
+     * @param 	 pos [in], 点位置
+     * @param 	 data [in], 所带数据
+     * @return 	 [true] 成功 or [false] 队列已满, 点被丢弃并计入 dropped()
+     */
+    bool push(const PosType& pos, const DataType& data)
+    {
+        if (!queue_.push(Sample{pos, data})) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        pushed_.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 	 [简介] 因队列已满而丢弃的点数
+     */
+    size_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 	 [简介] 获取最近一次发布的只读副本
+     * @return 	 [std::shared_ptr<const Snapshot>] 返回副本, 持有期间不会被释放
+     */
+    std::shared_ptr<const Snapshot> snapshot() const { return std::atomic_load(&snapshot_); }
+
+    /**
+     * @brief 	 [简介] 等待调用前提交的点全部插入并发布
+     * @return 	 [true] 全部发布 or [false] 建图线程已停止, 停止后提交的点不会再被处理
+     */
+    bool flush()
+    {
+        size_t target = pushed_.load(std::memory_order_acquire);
+        while (published_.load(std::memory_order_acquire) < target) {
+            // 建图线程退出后不会再发布, 停止后提交的点永远等不到
+            if (finished_.load(std::memory_order_acquire)) return published_.load(std::memory_order_acquire) >= target;
+            publish_request_.store(true, std::memory_order_release);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    /**
+     * @brief 	 [简介] 停止建图线程, 停止前会处理完队列中的点并发布最终副本
+     */
+    void stop()
+    {
+        if (!running_.exchange(false)) return;
+        if (builder_.joinable()) builder_.join();
+    }
+private:
+    struct Sample
+    {
+        PosType pos;
+        DataType data;
+    };
+
+    /**
+     * @brief 	 [简介] 建图线程主循环
+     */
+    void run()
+    {
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point last_publish = Clock::now();
+        Clock::duration cost(0);    // 上一次发布的耗时
+        size_t applied = 0;
+        bool dirty = false;
+
+        while (true) {
+            bool running = running_.load(std::memory_order_acquire);
+            size_t count = apply_batch();
+            applied += count;
+            dirty = dirty || count > 0;
+
+            // 发布的代价与树的大小成正比, 距上次发布不足其耗时的请求推迟到之后的循环
+            Clock::time_point now = Clock::now();
+            bool due = now - last_publish >= publish_period_;
+            bool allowed = now - last_publish >= cost || !running;
+            bool requested = publish_request_.load(std::memory_order_acquire);
+            if (dirty && (due || requested || !running) && allowed) {
+                publish_request_.store(false, std::memory_order_release);
+                publish(applied);
+                last_publish = Clock::now();
+                cost = last_publish - now;
+                dirty = false;
+            } else if (requested && !dirty) {
+                publish_request_.store(false, std::memory_order_release);
+                published_.store(applied, std::memory_order_release);
+            }
+
+            if (!running && count == 0) break;
+            if (count == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        finished_.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief 	 [简介] 从队列中取出至多 batch_size_ 个点插入树中
+     * @return 	 [size_t] 返回本批插入的点数
+     */
+    size_t apply_batch()
+    {
+        Sample sample;
+        size_t count = 0;
+        while (count < batch_size_ && queue_.pop(sample)) {
+            tree_.insert(sample.pos, sample.data);
+            ++count;
+        }
+        return count;
+    }
+
+    /**
+     * @brief 	 [简介] 生成新的只读副本并原子替换
+     * @param 	 applied [in], 副本包含的点数
+     */
+    void publish(size_t applied)
+    {
+        std::shared_ptr<const Snapshot> snapshot = std::allocate_shared<Snapshot>(AlignedAllocator<Snapshot>(), tree_);
+        std::atomic_store(&snapshot_, snapshot);
+        published_.store(applied, std::memory_order_release);
+    }
+private:
+    MpscQueue<Sample> queue_;
+    Tree tree_;
+    size_t batch_size_;
+    std::chrono::milliseconds publish_period_;
+    std::shared_ptr<const Snapshot> snapshot_;
+    std::atomic<size_t> pushed_;
+    std::atomic<size_t> dropped_;
+    std::atomic<size_t> published_;
+    std::atomic<bool> publish_request_;
+    std::atomic<bool> running_;
+    std::atomic<bool> finished_;        // 建图线程已退出
+    std::thread builder_;
+};
+
+#endif // __OCTREE_PIPELINE_H__
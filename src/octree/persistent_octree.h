@@ -0,0 +1,230 @@
+/**
+ * Copyright (C), 2023
+ * @file 	 persistent_octree.h
+ * @author 	 peitianyu(https://github.com/peitianyu)
+ * @date 	 2026-10-17
+ * @brief 	 [简介] 写时复制的持久化四叉树/八叉树, 每次插入生成新版本, 版本间共享未修改的子树
+ */
+#ifndef __PERSISTENT_OCTREE_H__
+#define __PERSISTENT_OCTREE_H__
+
+#include <memory>
+#include <functional>
+#include <vector>
+#include "octree/octree.h"
+
+/**
+ * @brief 	 [简介] 持久化树, 节点不可变且带引用计数
+ * @note 	 [注意] with_insert 只复制从根到叶子的 O(depth) 个节点, 其余子树与旧版本共享;
+ *                  版本本身只持有一个根指针和所有版本共享的参数(半尺寸表、数据更新方法), 拷贝代价为常数;
+ *                  版本按值返回, 虚函数不能随版本传递, 所以数据更新方法在构造时给出, 对应 Octree::update
+ */
+template <typename PosType, typename DataType, size_t DIM>
+class PersistentOctree {
+public:
+    using Tree = Octree<PosType, DataType, DIM>;
+    using Boundary = typename Tree::Boundary;
+    constexpr static size_t child_num_ = 1 << DIM;
+
+    using Update = std::function<DataType(const DataType& old_data, const DataType& new_data)>;
+
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+    struct Node
+    {
+        PosType center;
+        DataType data;
+        size_t depth;
+        NodePtr childs[child_num_];
+
+        Node(const PosType& center, const DataType& data, size_t depth)
+            : center(center), data(data), depth(depth) { }
+    };
+
+    /**
+     * @brief 	 [简介] 构造函数, 生成空树版本
+     * @param 	 min [in], 边界最小值
+     * @param 	 max [in], 边界最大值
+     * @param 	 depth [in], 最大深度
+     * @param 	 update [in], 数据更新方法 update(旧数据, 新数据), 为空时与 Octree::update 的默认方法一致, 为加法
+     * @note 	 [注意] 由同样边界的空 Octree 生成, 节点中心和半尺寸与 Octree 一致
+     */
+    PersistentOctree(const PosType& min, const PosType& max, size_t depth, Update update = Update())
+        : PersistentOctree(Tree(min, max, depth), std::move(update)) { }
+
+    /**
+     * @brief 	 [简介] 构造函数, 从可写的 Octree 生成第一个版本
+     * @param 	 tree [in], 源树, 可以使用任意的 RefPolicy 和内部坐标类型, 节点中心统一转换为 PosType
+     * @param 	 update [in], 数据更新方法, 源树重写了 Octree::update 时传入相同的方法, 为空时为加法
+     */
+    template <typename RefPolicy, typename Coord>
+    explicit PersistentOctree(const Octree<PosType, DataType, DIM, RefPolicy, Coord>& tree, Update update = Update())
+        : boundary_(tree.boundary().min, tree.boundary().max), max_depth_(tree.max_depth()),
+          shared_(share(tree, std::move(update))), root_(copy(tree, tree.root())) { }
+
+    /**
+     * @brief 	 [简介] 插入点, 生成新版本, 本版本不变
+     * @param 	 pos [in], 点位置
+     * @param 	 data [in], 所带数据
+     * @return 	 [PersistentOctree] 返回新版本
+     */
+    PersistentOctree with_insert(const PosType& pos, const DataType& data) const
+    {
+        if (!boundary_.is_in(pos)) return *this;
+        return PersistentOctree(boundary_, max_depth_, shared_, insert(root_.get(), root_->data, pos, data));
+    }
+
+    /**
+     * @brief 	 [简介] 用于查找点
+     * @param 	 pos [in], 点位置
+     * @return 	 [const Node*], 返回节点指针
+     */
+    const Node *find(const PosType& pos) const { return find(pos, max_depth_); }
+
+    /**
+     * @brief 	 [简介] 用于查找点
+     * @param 	 pos [in], 点位置
+     * @param 	 depth [in], 查找深度
+     * @return 	 [const Node*], 返回节点指针, 节点随版本存活
+     */
+    const Node *find(const PosType& pos, const size_t& depth) const
+    {
+        const Node *node = root_.get();
+        while (node->depth < depth) {
+            const Node *child = node->childs[find_index(pos, node)].get();
+            if (child == nullptr) break;
+            node = child;
+        }
+        return node;
+    }
+
+    /**
+     * @brief 	 [简介] 找到节点的边界
+     * @param 	 node [in], 需要找到边界的节点
+     * @param 	 boundary [in], 边界
+     */
+    void find_boundary(const Node* node, Boundary& boundary) const
+    {
+        const PosType& half_size = shared_->half_sizes[node->depth];
+        boundary.min = node->center - half_size;
+        boundary.max = node->center + half_size;
+    }
+
+    /**
+     * @brief 	 [简介] 可视化树
+     * @param 	 func [in], 可视化函数
+     */
+    void visual(std::function<void(const Node* node)> func) const { traverse(root_.get(), func); }
+
+    /**
+     * @brief 	 [简介] 获取根节点, 可用于判断两个版本是否共享子树
+     */
+    const Node *root() const { return root_.get(); }
+
+    const Boundary& boundary() const { return boundary_; }
+    size_t max_depth() const { return max_depth_; }
+private:
+    /**
+     * @brief 	 [简介] 所有版本共享的不可变参数
+     */
+    struct Shared
+    {
+        AlignedVector<PosType> half_sizes;    // 每层节点的半尺寸, 取自源树
+        Update update;
+    };
+
+    PersistentOctree(const Boundary& boundary, size_t depth, const std::shared_ptr<const Shared>& shared, const NodePtr& root)
+        : boundary_(boundary), max_depth_(depth), shared_(shared), root_(root) { }
+
+    template <typename SrcTree>
+    static std::shared_ptr<const Shared> share(const SrcTree& tree, Update update)
+    {
+        std::shared_ptr<Shared> shared = std::make_shared<Shared>();
+        for (size_t d = 0; d <= tree.max_depth(); ++d) shared->half_sizes.push_back(tree.half_size(d));
+        shared->update = std::move(update);
+        return shared;
+    }
+
+    /**
+     * @brief 	 [简介] 沿插入路径复制节点
+     * @param 	 node [in], 旧节点
+     * @param 	 node_data [in], 新节点的数据
+     * @param 	 pos [in], 插入点位置
+     * @param 	 data [in], 插入点数据
+     * @return 	 [NodePtr] 返回新节点, 不在路径上的子节点与旧节点共享
+     * @note 	 [注意] 与 Octree::insert 的规则一致, 叶子在 max_depth_ - 1 层
+     */
+    NodePtr insert(const Node *node, const DataType& node_data, const PosType& pos, const DataType& data) const
+    {
+        std::shared_ptr<Node> copy = std::allocate_shared<Node>(AlignedAllocator<Node>(), *node);
+        copy->data = node_data;
+        if (node->depth + 1 == max_depth_) return copy;
+
+        size_t index = find_index(pos, node);
+        const Node *child = node->childs[index].get();
+        if (child == nullptr) {
+            Node fresh(find_center(pos, node), data, node->depth + 1);
+            copy->childs[index] = insert(&fresh, data, pos, data);
+        } else {
+            copy->childs[index] = insert(child, update(child->data, data), pos, data);
+        }
+        return copy;
+    }
+
+    /**
+     * @brief 	 [简介] 更新节点数据方法, 插入路径上已有节点的数据都经过这里; 默认与 Octree::update 一致, 为加法
+     */
+    DataType update(const DataType& old_data, const DataType& new_data) const
+    {
+        return shared_->update ? shared_->update(old_data, new_data) : (new_data + old_data);
+    }
+
+    /**
+     * @brief 	 [简介] 递归复制 Octree 的子树
+     */
+    template <typename SrcTree, typename SrcNode>
+    static NodePtr copy(const SrcTree& tree, const SrcNode *node)
+    {
+        std::shared_ptr<Node> copy_node = std::allocate_shared<Node>(AlignedAllocator<Node>(), tree.position(node), node->data, node->depth);
+        for (size_t i = 0; i < child_num_; ++i) {
+            if (tree.child(node, i) != nullptr) copy_node->childs[i] = copy(tree, tree.child(node, i));
+        }
+        return copy_node;
+    }
+
+    void traverse(const Node *node, std::function<void(const Node* node)> func) const
+    {
+        if (node == nullptr) return;
+        func(node);
+        for (size_t i = 0; i < child_num_; i++) traverse(node->childs[i].get(), func);
+    }
+
+    size_t find_index(const PosType& pos, const Node *node) const
+    {
+        size_t index = 0;
+        for (size_t i = 0; i < DIM; ++i) {
+            if (pos[i] > node->center[i]) index |= (1 << i);
+        }
+        return index;
+    }
+
+    PosType find_center(const PosType& pos, const Node *node) const
+    {
+        PosType center = node->center;
+        const PosType& half_size = shared_->half_sizes[node->depth + 1];
+        for (size_t i = 0; i < DIM; ++i) {
+            center[i] = (pos[i] > node->center[i]) ? center[i] + half_size[i] : center[i] - half_size[i];
+        }
+        return center;
+    }
+private:
+    Boundary boundary_;
+    size_t max_depth_;
+    std::shared_ptr<const Shared> shared_;
+    NodePtr root_;
+};
+
+template<typename PosType, typename DataType> using PersistentQuadTree = PersistentOctree<PosType, DataType, 2>;
+template<typename PosType, typename DataType> using PersistentOctTree = PersistentOctree<PosType, DataType, 3>;
+
+#endif // __PERSISTENT_OCTREE_H__
@@ -0,0 +1,122 @@
+/**
+ * Copyright (C), 2023
+ * @file 	 space_curve.h
+ * @author 	 peitianyu(https://github.com/peitianyu)
+ * @date 	 2026-10-17
+ * @brief 	 [简介] 空间填充曲线: Morton(Z 序)编码与 Hilbert 编码之间的转换, 用于节点排序
+ */
+#ifndef __SPACE_CURVE_H__
+#define __SPACE_CURVE_H__
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 	 [简介] 节点排序使用的空间填充曲线
+ * @note 	 [注意] MORTON 即按子区域id排序, 相邻的子区域在区域边界处会跳跃;
+ *                  HILBERT 中相邻编码的格子总是相邻, 长条形区域的范围查询访问的内存更集中
+ */
+enum class Curve { MORTON, HILBERT };
+
+/**
+ * @brief 	 [简介] Morton 编码 -> Hilbert 编码
+ * @param 	 key [in], Morton 编码, 与 Octree::find_key 相同: 从第 1 层开始每层 DIM 位, 第 i 位表示第 i 轴在上半部分
+ * @param 	 depth [in], 编码的层数, 即每个轴的位数, 不超过 hilbert_levels<DIM>()
+ * @return 	 [uint64_t] 返回同一个格子在 2^depth 网格上的 Hilbert 编码
+ * @note 	 [注意] 使用 Skilling 的转置算法(AIP Conf. Proc. 707, 2004), 适用于任意维度;
+ *                  同一 depth 下, 任意一个对齐的子块在 Hilbert 序中都是连续的一段
+ */
+template <size_t DIM>
+uint64_t morton_to_hilbert(uint64_t key, size_t depth)
+{
+    if (depth == 0) return 0;
+
+    // 拆出每个轴的整数坐标
+    uint32_t x[DIM] = {};
+    for (size_t level = 0; level < depth; ++level) {
+        uint64_t digit = key >> (DIM * (depth - 1 - level));
+        for (size_t i = 0; i < DIM; ++i) x[i] |= uint32_t((digit >> i) & 1) << (depth - 1 - level);
+    }
+
+    // 坐标 -> 转置形式的 Hilbert 编码
+    uint32_t top = uint32_t(1) << (depth - 1);
+    for (uint32_t q = top; q > 1; q >>= 1) {
+        uint32_t p = q - 1;
+        for (size_t i = 0; i < DIM; ++i) {
+            if (x[i] & q) {
+                x[0] ^= p;
+            } else {
+                uint32_t t = (x[0] ^ x[i]) & p;
+                x[0] ^= t;
+                x[i] ^= t;
+            }
+        }
+    }
+    for (size_t i = 1; i < DIM; ++i) x[i] ^= x[i - 1];
+    uint32_t t = 0;
+    for (uint32_t q = top; q > 1; q >>= 1) {
+        if (x[DIM - 1] & q) t ^= q - 1;
+    }
+    for (size_t i = 0; i < DIM; ++i) x[i] ^= t;
+
+    // 按位交织, 高位在前, 每层中第 0 轴为最高位
+    uint64_t hilbert = 0;
+    for (size_t bit = depth; bit-- > 0;) {
+        for (size_t i = 0; i < DIM; ++i) hilbert = (hilbert << 1) | ((x[i] >> bit) & 1);
+    }
+    return hilbert;
+}
+
+/**
+ * @brief 	 [简介] Hilbert 编码最多容纳的层数: 编码为 64 位, 每个轴的坐标为 32 位
+ */
+template <size_t DIM>
+constexpr size_t hilbert_levels() { return 64 / DIM < 32 ? 64 / DIM : 32; }
+
+/**
+ * @brief 	 [简介] 最大深度为 max_depth 的树计算 Hilbert 序时参照的网格层数
+ * @param 	 max_depth [in], 树的最大深度
+ * @return 	 [size_t] 返回叶子层(max_depth - 1), 超过 hilbert_levels 时截断;
+ *                    更深的节点不再有 Hilbert 编码, 其子节点按子区域id排列
+ */
+template <size_t DIM>
+size_t hilbert_bottom(size_t max_depth)
+{
+    size_t bottom = max_depth > 1 ? max_depth - 1 : 1;
+    return bottom < hilbert_levels<DIM>() ? bottom : hilbert_levels<DIM>();
+}
+
+/**
+ * @brief 	 [简介] 第 depth 层节点在 Hilbert 序中的位置, 在同一个 bottom 下不同层的结果可以一起比较
+ * @param 	 key [in], 节点的 Morton 编码(depth 层)
+ * @param 	 depth [in], 节点深度
+ * @param 	 bottom [in], 参照的网格层数, 不小于 depth, 不超过 hilbert_levels<DIM>()
+ * @return 	 [uint64_t] 返回节点所覆盖的那一段 Hilbert 编码的序号
+ * @note 	 [注意] Hilbert 曲线在不同分辨率下的方向不同, 所以统一在 bottom 层上编码, 再去掉低位
+ */
+template <size_t DIM>
+uint64_t hilbert_prefix(uint64_t key, size_t depth, size_t bottom)
+{
+    if (depth == 0) return 0;
+    size_t shift = DIM * (bottom - depth);
+    return morton_to_hilbert<DIM>(key << shift, bottom) >> shift;
+}
+
+/**
+ * @brief 	 [简介] 第 depth 层节点的 2^DIM 个子区域按 Hilbert 序的排列
+ * @param 	 key [in], 节点的 Morton 编码(depth 层)
+ * @param 	 depth [in], 节点深度, 子节点在 depth + 1 层
+ * @param 	 bottom [in], 参照的网格层数, 不小于 depth + 1
+ * @param 	 order [out], 长度为 2^DIM, order[k] 为 Hilbert 序中第 k 个子区域的id
+ * @note 	 [注意] 同一个父节点的子区域的编码只有最低 DIM 位不同, 所以最低 DIM 位就是它们的次序
+ */
+template <size_t DIM>
+void hilbert_child_order(uint64_t key, size_t depth, size_t bottom, size_t *order)
+{
+    const uint64_t mask = (uint64_t(1) << DIM) - 1;
+    for (size_t i = 0; i <= mask; ++i) {
+        order[hilbert_prefix<DIM>((key << DIM) | i, depth + 1, bottom) & mask] = i;
+    }
+}
+
+#endif // __SPACE_CURVE_H__
@@ -0,0 +1,104 @@
+/**
+ * Copyright (C), 2023
+ * @file 	 static_octree.h
+ * @author 	 peitianyu(https://github.com/peitianyu)
+ * @date 	 2026-10-17
+ * @brief 	 [简介] 最大深度为编译期常量的四叉树/八叉树, 查找和编码的下降循环在编译期展开
+ */
+#ifndef __STATIC_OCTREE_H__
+#define __STATIC_OCTREE_H__
+
+#include <type_traits>
+#include "octree/octree.h"
+
+/**
+ * @brief 	 [简介] 编译期深度的树, 其余行为与 Octree 完全相同
+ * @note 	 [注意] 边界在运行期给出, 每层的半尺寸表在构造时算好(Octree::half_sizes_);
+ *                  MaxDepth 为模板参数后, 每层查表的下标和循环次数都是常量, 下降被展开成 MaxDepth - 1 段直线代码;
+ *                  find(pos) 不使用稠密/哈希索引, 直接从根节点下降
+ */
+template <typename PosType, typename DataType, size_t DIM, size_t MaxDepth, typename RefPolicy = PointerRef, typename Coord = PosType>
+class StaticOctree : public Octree<PosType, DataType, DIM, RefPolicy, Coord> {
+    static_assert(MaxDepth >= 1 && (MaxDepth - 1) * DIM <= 64, "key holds at most 64 / DIM levels");
+public:
+    using Base = Octree<PosType, DataType, DIM, RefPolicy, Coord>;
+    static_assert(MaxDepth <= Base::max_depth_limit_, "MaxDepth exceeds the half-size table");
+    using Node = typename Base::Node;
+    using Key = typename Base::Key;
+    constexpr static size_t max_depth_static_ = MaxDepth;
+
+    /**
+     * @brief 	 [简介] 构造函数
+     * @param 	 min [in], 边界最小值
+     * @param 	 max [in], 边界最大值
+     */
+    StaticOctree(const PosType& min, const PosType& max) : Base(min, max, MaxDepth) { }
+
+    using Base::find;
+    using Base::find_key;
+
+    /**
+     * @brief 	 [简介] 用于查找点, 结果与 Octree::find(pos) 相同
+     * @param 	 pos [in], 点位置
+     * @return 	 [Node*], 返回路径上最深的节点
+     */
+    Node *find(const PosType& pos)
+    {
+        if (this->memory_limit_ != 0) ++this->tick_;
+        return descend(this->root_, this->to_coord(pos), Level<0>());
+    }
+
+    /**
+     * @brief 	 [简介] 叶子层(第 MaxDepth - 1 层)的节点编码, 结果与 Octree::find_key(pos, MaxDepth - 1) 相同
+     */
+    Key find_key(const PosType& pos) const
+    {
+        using Scalar = typename Base::Scalar;
+        Coord coord = this->to_coord(pos);
+        Scalar p[DIM], center[DIM];
+        for (size_t i = 0; i < DIM; ++i) {
+            p[i] = coord[i];
+            center[i] = this->center_[i];
+        }
+        return key_at(p, center, Key(0), Level<0>());
+    }
+private:
+    template <size_t L> using Level = std::integral_constant<size_t, L>;
+
+    template <size_t L>
+    Node *descend(Node *node, const Coord& pos, Level<L>)
+    {
+        this->touch(node, this->tick_);
+        Node *next = this->child(node, VecKernel<Coord, DIM>::find_index(pos, node->center));
+        if (next == nullptr) return node;
+        return descend(next, pos, Level<L + 1>());
+    }
+
+    Node *descend(Node *node, const Coord&, Level<MaxDepth - 1>)
+    {
+        this->touch(node, this->tick_);
+        return node;
+    }
+
+    // 与 Octree::coord_key 相同, 在标量数组上无分支地移动中心
+    template <typename Scalar, size_t L>
+    Key key_at(const Scalar *pos, Scalar *center, Key key, Level<L>) const
+    {
+        const Coord& half_size = this->half_sizes_[L + 1];
+        size_t index = 0;
+        for (size_t i = 0; i < DIM; ++i) {
+            bool upper = pos[i] > center[i];
+            index |= size_t(upper) << i;
+            center[i] += Scalar(2 * int(upper) - 1) * half_size[i];
+        }
+        return key_at(pos, center, (key << DIM) | index, Level<L + 1>());
+    }
+
+    template <typename Scalar>
+    Key key_at(const Scalar *, Scalar *, Key key, Level<MaxDepth - 1>) const { return key; }
+};
+
+template<typename PosType, typename DataType, size_t MaxDepth> using StaticQuadTree = StaticOctree<PosType, DataType, 2, MaxDepth>;
+template<typename PosType, typename DataType, size_t MaxDepth> using StaticOctTree = StaticOctree<PosType, DataType, 3, MaxDepth>;
+
+#endif // __STATIC_OCTREE_H__
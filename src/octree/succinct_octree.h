@@ -0,0 +1,290 @@
+/**
+ * Copyright (C), 2023
+ * @file 	 succinct_octree.h
+ * @author 	 peitianyu(https://github.com/peitianyu)
+ * @date 	 2026-10-17
+ * @brief 	 [简介] 简洁(succinct)的只读四叉树/八叉树, 拓扑用层序位向量 + rank/select 表示, 用于静态参考地图
+ */
+#ifndef __SUCCINCT_OCTREE_H__
+#define __SUCCINCT_OCTREE_H__
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "octree/octree.h"
+
+/**
+ * @brief 	 [简介] 支持 rank/select 的只读位向量
+ * @note 	 [注意] 每 512 位记录一次之前 1 的个数, 额外空间约为 6%
+ */
+class RankBitVector {
+public:
+    RankBitVector() : size_(0) { }
+
+    /**
+     * @brief 	 [简介] 追加一位, 只能在 build 之前调用
+     */
+    void push_back(bool bit)
+    {
+        if (size_ % 64 == 0) words_.push_back(0);
+        if (bit) words_.back() |= uint64_t(1) << (size_ % 64);
+        ++size_;
+    }
+
+    /**
+     * @brief 	 [简介] 建立 rank 索引
+     */
+    void build()
+    {
+        size_t block_num = (words_.size() + block_words_ - 1) / block_words_;
+        blocks_.assign(block_num + 1, 0);
+        uint32_t count = 0;
+        for (size_t i = 0; i < words_.size(); ++i) {
+            if (i % block_words_ == 0) blocks_[i / block_words_] = count;
+            count += uint32_t(__builtin_popcountll(words_[i]));
+        }
+        blocks_[block_num] = count;
+    }
+
+    bool get(size_t pos) const { return (words_[pos / 64] >> (pos % 64)) & 1; }
+
+    /**
+     * @brief 	 [简介] [0, pos) 中 1 的个数
+     */
+    size_t rank1(size_t pos) const
+    {
+        size_t word = pos / 64;
+        size_t count = blocks_[word / block_words_];
+        for (size_t i = word / block_words_ * block_words_; i < word; ++i) count += __builtin_popcountll(words_[i]);
+        if (pos % 64) count += __builtin_popcountll(words_[word] & ((uint64_t(1) << (pos % 64)) - 1));
+        return count;
+    }
+
+    /**
+     * @brief 	 [简介] 第 k 个 1 的位置(k 从 0 开始)
+     */
+    size_t select1(size_t k) const
+    {
+        // 二分找到包含第 k 个 1 的块, 再逐字、逐位查找
+        size_t block = std::upper_bound(blocks_.begin(), blocks_.end(), uint32_t(k)) - blocks_.begin() - 1;
+        size_t remain = k - blocks_[block];
+        size_t word = block * block_words_;
+        while (true) {
+            size_t count = __builtin_popcountll(words_[word]);
+            if (remain < count) break;
+            remain -= count;
+            ++word;
+        }
+        uint64_t bits = words_[word];
+        for (size_t i = 0; i < remain; ++i) bits &= bits - 1;
+        return word * 64 + __builtin_ctzll(bits);
+    }
+
+    size_t size() const { return size_; }
+    size_t bytes() const { return words_.size() * sizeof(uint64_t) + blocks_.size() * sizeof(uint32_t); }
+private:
+    constexpr static size_t block_words_ = 8;
+    std::vector<uint64_t> words_;
+    std::vector<uint32_t> blocks_;
+    size_t size_;
+};
+
+/**
+ * @brief 	 [简介] 简洁只读树
+ * @note 	 [注意] 节点按层序编号, 编号为 v 的节点的第 i 个子区域对应第 v * child_num_ + i 位;
+ *                  子节点编号 = rank1(该位) + 1, 父节点编号 = select1(v - 1) / child_num_;
+ *                  叶子层的节点排在最后且不占位; 节点中心和深度在下降时计算, 不存储
+ */
+template <typename PosType, typename DataType, size_t DIM>
+class SuccinctOctree {
+public:
+    using Tree = Octree<PosType, DataType, DIM>;
+    using Boundary = typename Tree::Boundary;
+    constexpr static size_t child_num_ = Tree::child_num_;
+
+    /**
+     * @brief 	 [简介] 查询结果, 按值返回
+     */
+    struct Node
+    {
+        size_t id;
+        size_t depth;
+        PosType center;
+        DataType data;
+    };
+
+    /**
+     * @brief 	 [简介] 构造函数, 从 Octree 生成只读副本
+     * @param 	 tree [in], 源树, 可以使用任意的 RefPolicy 和内部坐标类型
+     */
+    template <typename RefPolicy, typename Coord>
+    explicit SuccinctOctree(const Octree<PosType, DataType, DIM, RefPolicy, Coord>& tree)
+        : boundary_(tree.boundary().min, tree.boundary().max), max_depth_(tree.max_depth()), inner_(0)
+    {
+        using SrcNode = typename Octree<PosType, DataType, DIM, RefPolicy, Coord>::Node;
+        center_ = tree.position(tree.root());
+        for (size_t d = 0; d <= max_depth_; ++d) half_sizes_.push_back(tree.half_size(d));
+        std::vector<const SrcNode*> order(1, tree.root());
+        for (size_t cur = 0; cur < order.size(); ++cur) {
+            const SrcNode *node = order[cur];
+            datas_.push_back(node->data);
+            if (node->depth + 1 >= max_depth_) continue;
+            ++inner_;
+            for (size_t i = 0; i < child_num_; ++i) {
+                const SrcNode *child = tree.child(node, i);
+                bits_.push_back(child != nullptr);
+                if (child != nullptr) order.push_back(child);
+            }
+        }
+        bits_.build();
+    }
+
+    /**
+     * @brief 	 [简介] 用于查找点
+     * @param 	 pos [in], 点位置
+     * @return 	 [Node], 返回节点
+     */
+    Node find(const PosType& pos) const { return find(pos, max_depth_); }
+
+    /**
+     * @brief 	 [简介] 用于查找点
+     * @param 	 pos [in], 点位置
+     * @param 	 depth [in], 查找深度
+     * @return 	 [Node], 返回路径上不超过 depth 的最深节点, 与 Octree::find 相同
+     */
+    Node find(const PosType& pos, const size_t& depth) const
+    {
+        size_t id = 0, d = 0;
+        PosType center = center_;
+        while (d < depth && id < inner_) {
+            size_t index = 0;
+            for (size_t i = 0; i < DIM; ++i) {
+                if (pos[i] > center[i]) index |= (1 << i);
+            }
+            size_t pos_bit = id * child_num_ + index;
+            if (!bits_.get(pos_bit)) break;
+            id = bits_.rank1(pos_bit) + 1;
+            center = child_center(center, d, index);
+            ++d;
+        }
+        return Node{id, d, center, datas_[id]};
+    }
+
+    /**
+     * @brief 	 [简介] 父节点编号
+     * @param 	 id [in], 节点编号, 不能是根节点
+     * @return 	 [size_t] 返回父节点编号
+     */
+    size_t parent(size_t id) const { return bits_.select1(id - 1) / child_num_; }
+
+    /**
+     * @brief 	 [简介] 找到节点的边界
+     */
+    void find_boundary(const Node& node, Boundary& boundary) const
+    {
+        const PosType& half_size = half_sizes_[node.depth];
+        boundary.min = node.center - half_size;
+        boundary.max = node.center + half_size;
+    }
+
+    /**
+     * @brief 	 [简介] 范围查询, 规则与 Octree::query_box 相同
+     */
+    void query_box(const PosType& min, const PosType& max, std::function<void(const Node& node)> func) const
+    {
+        query_box(min, max, func, max_depth_);
+    }
+
+    void query_box(const PosType& min, const PosType& max, std::function<void(const Node& node)> func, size_t depth) const
+    {
+        Boundary box(min, max);
+        visit(Node{0, 0, center_, datas_[0]}, depth, func, [&box](const Boundary& boundary) {
+            for (size_t i = 0; i < DIM; ++i) {
+                if (boundary.min[i] > box.max[i] || boundary.max[i] < box.min[i]) return false;
+            }
+            return true;
+        });
+    }
+
+    /**
+     * @brief 	 [简介] 半径查询, 规则与 Octree::query_radius 相同
+     */
+    void query_radius(const PosType& center, double radius, std::function<void(const Node& node)> func) const
+    {
+        query_radius(center, radius, func, max_depth_);
+    }
+
+    void query_radius(const PosType& center, double radius, std::function<void(const Node& node)> func, size_t depth) const
+    {
+        double radius2 = radius * radius;
+        visit(Node{0, 0, center_, datas_[0]}, depth, func, [&center, radius2](const Boundary& boundary) {
+            double dist2 = 0;
+            for (size_t i = 0; i < DIM; ++i) {
+                double d = std::max(double(boundary.min[i] - center[i]), std::max(0.0, double(center[i] - boundary.max[i])));
+                dist2 += d * d;
+            }
+            return dist2 <= radius2;
+        });
+    }
+
+    /**
+     * @brief 	 [简介] 节点数量
+     */
+    size_t size() const { return datas_.size(); }
+
+    /**
+     * @brief 	 [简介] 占用内存(字节)
+     */
+    size_t memory_usage() const { return sizeof(*this) + bits_.bytes() + datas_.size() * sizeof(DataType) + half_sizes_.size() * sizeof(PosType); }
+
+    const Boundary& boundary() const { return boundary_; }
+    size_t max_depth() const { return max_depth_; }
+private:
+    /**
+     * @brief 	 [简介] 递归访问与查询区域相交的节点
+     * @param 	 node [in], 当前节点
+     * @param 	 depth [in], 查询深度
+     * @param 	 func [in], 访问函数
+     * @param 	 overlap [in], 判断节点边界是否与查询区域相交
+     */
+    template <typename Overlap>
+    void visit(const Node& node, size_t depth, std::function<void(const Node& node)>& func, const Overlap& overlap) const
+    {
+        Boundary boundary;
+        find_boundary(node, boundary);
+        if (!overlap(boundary)) return;
+
+        bool leaf = true;
+        if (node.depth < depth && node.id < inner_) {
+            for (size_t i = 0; i < child_num_; ++i) {
+                size_t pos_bit = node.id * child_num_ + i;
+                if (!bits_.get(pos_bit)) continue;
+                leaf = false;
+                size_t id = bits_.rank1(pos_bit) + 1;
+                visit(Node{id, node.depth + 1, child_center(node.center, node.depth, i), datas_[id]}, depth, func, overlap);
+            }
+        }
+        if (leaf) func(node);
+    }
+
+    PosType child_center(const PosType& center, size_t depth, size_t index) const
+    {
+        PosType child = center;
+        const PosType& half_size = half_sizes_[depth + 1];
+        for (size_t i = 0; i < DIM; ++i) {
+            child[i] = (index & (1 << i)) ? center[i] + half_size[i] : center[i] - half_size[i];
+        }
+        return child;
+    }
+private:
+    Boundary boundary_;
+    size_t max_depth_;
+    size_t inner_;              // 非叶子层的节点数, 只有它们占位
+    PosType center_;                    // 根节点中心
+    AlignedVector<PosType> half_sizes_; // 每层节点的半尺寸, 取自源树
+    RankBitVector bits_;
+    AlignedVector<DataType> datas_;
+};
+
+#endif // __SUCCINCT_OCTREE_H__
@@ -0,0 +1,81 @@
+#include "core/tt_test.h"
+#include "octree/chunked_world.h"
+#include <Eigen/Core>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using Point = Eigen::Vector2d;
+using World = ChunkedWorld<Point, double, 2>;
+
+TEST(chunked_world, test)
+{
+    // 清理上一次运行留下的分块文件
+    for (int x = -6; x <= 5; ++x) for (int y = -6; y <= 5; ++y) {
+        std::remove(("chunked_world_test/chunk_" + std::to_string(x) + "_" + std::to_string(y) + ".oct").c_str());
+    }
+
+    std::vector<Point> points;
+    for (int i = 0; i < 2000; ++i) points.emplace_back((i * 37) % 1000 - 500.5, (i * 53) % 1000 - 500.5);
+
+    {
+        // 预算只够放几个分块, 插入过程中会不断换出
+        World world(Point(100, 100), 5, "chunked_world_test", 64 * 1024);
+        for (const Point& p : points) world.insert(p, 1);
+        ASSERT_LE(world.memory_usage(), 64 * 1024u);
+        ASSERT_LT(world.loaded_chunks(), 100u);
+
+        // 换出的分块可以被透明地重新加载
+        World::Node *node = world.find(points[0]);
+        ASSERT_TRUE(node != nullptr);
+        ASSERT_EQ(node->depth, 4u);
+        ASSERT_GE(node->data, 1);
+        ASSERT_TRUE(world.find(Point(1e6, 1e6)) == nullptr);
+    }
+
+    {
+        World world(Point(100, 100), 5, "chunked_world_test", 1 << 20);
+        double total = 0;
+        world.query_box(Point(-501, -501), Point(500, 500), [&total](World::Node* node) { total += node->data; });
+        ASSERT_EQ(total, double(points.size()));
+    }
+
+    {
+        // 目录无法创建, 写回失败的分块留在内存中, 数据不丢失
+        World broken(Point(100, 100), 5, "/dev/null/chunked_world_test", 64 * 1024);
+        for (const Point& p : points) broken.insert(p, 1);
+        ASSERT_GT(broken.memory_usage(), 64 * 1024u);
+        double total = 0;
+        broken.query_box(Point(-501, -501), Point(500, 500), [&total](World::Node* node) { total += node->data; });
+        ASSERT_EQ(total, double(points.size()));
+        ASSERT_FALSE(broken.flush());
+    }
+
+    World world(Point(100, 100), 5, "chunked_world_test", 1 << 20);
+    std::vector<Point> path = {Point(-450, -450), Point(-350, -450), Point(-250, -450)};
+    world.prefetch(path);
+    ASSERT_EQ(world.loaded_chunks(), 3u);
+}
+
+TEST(chunked_world, corrupt_chunk)
+{
+    // 存在但无法加载的分块文件不会被当作不存在, 也不会被空分块覆盖
+    World world(Point(100, 100), 5, "chunked_world_test", 1 << 20);
+    const std::string path = "chunked_world_test/chunk_7_7.oct", bytes = "not an octree";
+    {
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        ofs << bytes;
+    }
+    ASSERT_FALSE(world.insert(Point(750, 750), 1));
+    ASSERT_TRUE(world.find(Point(750, 750)) == nullptr);
+    ASSERT_EQ(world.loaded_chunks(), 0u);
+    ASSERT_TRUE(world.flush());
+    std::ifstream ifs(path, std::ios::binary);
+    ASSERT_TRUE(std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()) == bytes);
+
+    // 文件恢复后可以正常加载
+    std::remove(path.c_str());
+    ASSERT_TRUE(world.insert(Point(750, 750), 1));
+    ASSERT_TRUE(world.find(Point(750, 750)) != nullptr);
+}
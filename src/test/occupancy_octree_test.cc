@@ -0,0 +1,83 @@
+#include "core/tt_test.h"
+#include "octree/occupancy_octree.h"
+#include <Eigen/Core>
+#include <iostream>
+
+using Point = Eigen::Vector3d;
+using Tree = OctTree<Point, bool>;
+using Occupancy = OccupancyOctTree<Point>;
+
+TEST(occupancy_octree, test)
+{
+    Tree tree(Point(0, 0, 0), Point(64, 64, 64), 7);
+    Occupancy occupancy(Point(0, 0, 0), Point(64, 64, 64), 7);
+    for (int i = 0; i < 20000; ++i) {
+        Point p((i * 13) % 64 + 0.5, (i * 29) % 64 + 0.5, (i * 7) % 61 + 0.5);
+        tree.insert(p, true);
+        occupancy.insert(p);
+    }
+
+    // 叶子区域被占据 <=> Octree 中存在叶子节点
+    for (int i = 0; i < 5000; ++i) {
+        Point q((i * 17) % 64 + 0.3, (i * 5) % 64 + 0.3, (i * 11) % 64 + 0.3);
+        ASSERT_EQ(occupancy.is_occupied(q), tree.find(q)->depth + 1 == tree.max_depth());
+        ASSERT_EQ(occupancy.find(q, 2).data, tree.find(q, 2)->depth == 2);
+    }
+    std::cout << "octree: " << tree.memory_usage() << " bytes, occupancy: " << occupancy.memory_usage() << " bytes" << std::endl;
+    ASSERT_LT(occupancy.memory_usage() * 5, tree.memory_usage());
+
+    size_t leaves = 0, cells = 0;
+    tree.query_box(Point(10, 10, 10), Point(30, 40, 50), [&leaves, &tree](Tree::Node* node) {
+        if (node->depth + 1 == tree.max_depth()) ++leaves;
+    });
+    occupancy.query_box(Point(10, 10, 10), Point(30, 40, 50), [&cells](const Occupancy::Node& node) {
+        cells += size_t(1) << (3 * (6 - node.depth));
+    });
+    ASSERT_EQ(cells, leaves);
+    ASSERT_TRUE(occupancy.box_occupied(Point(10, 10, 10), Point(30, 40, 50)));
+}
+
+TEST(occupancy_octree, prune)
+{
+    // 填满一个区域后合并为一个全部占据的子区域
+    Occupancy occupancy(Point(0, 0, 0), Point(8, 8, 8), 4);
+    for (int x = 0; x < 4; ++x) for (int y = 0; y < 4; ++y) for (int z = 0; z < 4; ++z) {
+        occupancy.insert(Point(x + 0.5, y + 0.5, z + 0.5));
+    }
+    ASSERT_EQ(occupancy.size(), 1u);
+    Occupancy::Node node = occupancy.find(Point(1, 1, 1));
+    ASSERT_EQ(node.depth, 1u);
+    ASSERT_TRUE(node.cell == Occupancy::Cell::FULL);
+    ASSERT_FALSE(occupancy.box_occupied(Point(5, 5, 5), Point(8, 8, 8)));
+
+    // 在全部占据的区域中挖掉一个叶子, 区域重新展开
+    occupancy.insert(Point(2.5, 2.5, 2.5), false);
+    ASSERT_FALSE(occupancy.is_occupied(Point(2.5, 2.5, 2.5)));
+    ASSERT_TRUE(occupancy.is_occupied(Point(3.5, 2.5, 2.5)));
+    ASSERT_EQ(occupancy.size(), 3u);
+
+    occupancy.insert(Point(2.5, 2.5, 2.5), true);
+    ASSERT_EQ(occupancy.size(), 1u);
+    for (int x = 0; x < 4; ++x) for (int y = 0; y < 4; ++y) for (int z = 0; z < 4; ++z) {
+        occupancy.insert(Point(x + 0.5, y + 0.5, z + 0.5), false);
+    }
+    ASSERT_FALSE(occupancy.box_occupied(Point(0, 0, 0), Point(8, 8, 8)));
+    ASSERT_EQ(occupancy.size(), 1u);
+}
+
+TEST(occupancy_octree, deep_tree)
+{
+    // 深度超过 31 层时节点边界同样正确, 超过上限的深度被截断
+    ASSERT_EQ(Occupancy(Point(0, 0, 0), Point(1, 1, 1), 1000).max_depth(), Tree::max_depth_limit_);
+    Occupancy occupancy(Point(0, 0, 0), Point(1, 1, 1), 40);
+    Point p(0.1, 0.2, 0.3);
+    occupancy.insert(p);
+    Occupancy::Node node = occupancy.find(p);
+    ASSERT_EQ(node.depth, 39u);
+    ASSERT_TRUE(node.data);
+    Occupancy::Boundary boundary;
+    occupancy.find_boundary(node, boundary);
+    ASSERT_TRUE(boundary.is_in(p));
+    ASSERT_LT((boundary.max - boundary.min).maxCoeff(), 1.0 / (1u << 31));
+    ASSERT_FALSE(occupancy.is_occupied(Point(0.1, 0.2, 0.3001)));
+}
@@ -0,0 +1,253 @@
+#include "core/tt_test.h"
+#include "core/tt_radix_sort.h"
+#include "octree/octree.h"
+#include "octree/static_octree.h"
+#include <Eigen/Core>
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+// 基准测试耗时较长, 用 SKIP_TEST 注册, 默认不运行; 需要时改为 TEST 或 JUST_RUN_TEST, 并用 -O2 编译, -O0 的耗时没有参考意义
+using Point = Eigen::Vector3d;
+using Tree = OctTree<Point, float>;
+
+/**
+ * @brief 	 [简介] 计时, 返回 func 执行的毫秒数
+ */
+template <typename Func>
+static double time_ms(Func func)
+{
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::vector<Point> random_points(size_t num, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(0, 100);
+    std::vector<Point> points(num);
+    for (Point& p : points) p = Point(dist(rng), dist(rng), dist(rng));
+    return points;
+}
+
+SKIP_TEST(octree_bench, layout)
+{
+    Tree tree(Point(0, 0, 0), Point(100, 100, 100), 9);
+    for (const Point& p : random_points(100000, 1)) tree.insert(p, 1);
+    std::vector<Point> queries = random_points(100000, 2);
+
+    const char *names[] = {"alloc", "dfs", "bfs", "veb", "hilbert"};
+    for (int layout = 0; layout < 5; ++layout) {
+        Tree copy = tree.clone();
+        if (layout > 0) copy.optimize_layout(Tree::Layout(layout - 1));
+
+        float sum = 0;
+        double find_ms = time_ms([&]() {
+            for (const Point& q : queries) sum += copy.find(q)->data;
+        });
+        double box_ms = time_ms([&]() {
+            for (size_t i = 0; i < 200; ++i) {
+                copy.query_box(queries[i], queries[i] + Point(10, 10, 10), [&sum](Tree::Node* node) { sum += node->data; });
+            }
+        });
+        std::cout << std::setw(6) << names[layout] << " find: " << std::setw(8) << find_ms << " ms"
+                  << "  query_box: " << std::setw(8) << box_ms << " ms  (" << sum << ")" << std::endl;
+        ASSERT_GT(sum, 0);
+    }
+}
+
+SKIP_TEST(octree_bench, curve)
+{
+    Tree tree(Point(0, 0, 0), Point(100, 100, 100), 9);
+    for (const Point& p : random_points(200000, 10)) tree.insert(p, 1);
+
+    // 立方体查询和沿 x 轴的长条(走廊)查询
+    std::vector<Point> corners = random_points(400, 11);
+    std::vector<std::pair<Point, Point>> cubes, corridors;
+    for (const Point& c : corners) {
+        cubes.emplace_back(c, c + Point(8, 8, 8));
+        corridors.emplace_back(Point(0, c[1], c[2]), Point(100, c[1] + 2, c[2] + 2));
+    }
+
+    const char *names[] = {"morton", "hilbert"};
+    for (int curve = 0; curve < 2; ++curve) {
+        Tree copy = tree.clone();
+        copy.optimize_layout(curve == 0 ? Tree::Layout::DFS : Tree::Layout::HILBERT);
+
+        for (const auto *boxes : {&cubes, &corridors}) {
+            float sum = 0;
+            double box_ms = time_ms([&]() {
+                for (const auto& box : *boxes) copy.query_box(box.first, box.second, [&sum](Tree::Node* node) { sum += node->data; });
+            });
+
+            // 访问局部性: 每次查询访问的 4KB 页数, 以及相邻两次访问的平均地址距离
+            size_t pages = 0;
+            double stride = 0, visits = 0;
+            for (const auto& box : *boxes) {
+                std::unordered_set<uintptr_t> touched;
+                uintptr_t last = 0;
+                copy.query_box(box.first, box.second, [&](Tree::Node* node) {
+                    uintptr_t addr = reinterpret_cast<uintptr_t>(node);
+                    touched.insert(addr >> 12);
+                    if (last != 0) stride += double(addr > last ? addr - last : last - addr);
+                    last = addr;
+                    ++visits;
+                });
+                pages += touched.size();
+            }
+            std::cout << std::setw(8) << names[curve] << (boxes == &cubes ? " cube     " : " corridor ") << "query_box: " << std::setw(8) << box_ms
+                      << " ms  pages/query: " << std::setw(8) << double(pages) / boxes->size()
+                      << "  stride: " << std::setw(8) << stride / std::max(visits, 1.0) << " B  (" << sum << ")" << std::endl;
+            ASSERT_GT(sum, 0);
+        }
+    }
+}
+
+SKIP_TEST(octree_bench, find_index)
+{
+    std::vector<Point> points = random_points(100000, 3), queries = random_points(100000, 4);
+    const char *names[] = {"descent", "dense 3", "hash"};
+    for (int mode = 0; mode < 3; ++mode) {
+        Tree tree(Point(0, 0, 0), Point(100, 100, 100), 10);
+        if (mode == 1) tree.set_dense_levels(3);
+        if (mode == 2) tree.set_hash_index(true);
+        for (const Point& p : points) tree.insert(p, 1);
+
+        float sum = 0;
+        double deep_ms = time_ms([&]() {
+            for (const Point& q : queries) sum += tree.find(q)->data;
+        });
+        double mid_ms = time_ms([&]() {
+            for (const Point& q : queries) sum += tree.find(q, 5)->data;
+        });
+        std::cout << std::setw(8) << names[mode] << " find(max): " << std::setw(8) << deep_ms << " ms"
+                  << "  find(5): " << std::setw(8) << mid_ms << " ms  (" << sum << ")" << std::endl;
+        ASSERT_GT(sum, 0);
+    }
+}
+
+SKIP_TEST(octree_bench, box_kernel)
+{
+    std::vector<Point> points = random_points(1 << 16, 5), centers = random_points(1 << 16, 6);
+    size_t scalar = 0, vector = 0;
+    double scalar_ms = time_ms([&]() {
+        for (int round = 0; round < 20; ++round) {
+            for (size_t i = 0; i < points.size(); ++i) scalar += ScalarBoxKernel<double, 3>::find_index(points[i].data(), centers[i].data());
+        }
+    });
+    double vector_ms = time_ms([&]() {
+        for (int round = 0; round < 20; ++round) {
+            for (size_t i = 0; i < points.size(); ++i) vector += BoxKernel<double, 3>::find_index(points[i].data(), centers[i].data());
+        }
+    });
+    std::cout << "find_index scalar: " << std::setw(8) << scalar_ms << " ms  simd: " << std::setw(8) << vector_ms << " ms" << std::endl;
+    ASSERT_EQ(scalar, vector);
+}
+
+SKIP_TEST(octree_bench, batch)
+{
+    std::vector<Point> points = random_points(100000, 7);
+    Eigen::Matrix3Xd cloud(3, points.size());
+    for (size_t j = 0; j < points.size(); ++j) cloud.col(j) = points[j];
+    std::vector<float> datas(points.size(), 1);
+
+    Tree single(Point(0, 0, 0), Point(100, 100, 100), 9), batch(Point(0, 0, 0), Point(100, 100, 100), 9);
+    double single_ms = time_ms([&]() {
+        for (Eigen::Index j = 0; j < cloud.cols(); ++j) single.insert(cloud.col(j), datas[j]);
+    });
+    double batch_ms = time_ms([&]() { batch.insert_batch(cloud, datas.data()); });
+
+    Eigen::VectorXf values(cloud.cols());
+    float sum = 0;
+    double find_ms = time_ms([&]() {
+        for (Eigen::Index j = 0; j < cloud.cols(); ++j) sum += single.find(cloud.col(j))->data;
+    });
+    Eigen::Matrix3Xd centers(3, cloud.cols());
+    double find_batch_ms = time_ms([&]() { batch.find_batch(cloud, values, centers, batch.max_depth()); });
+    std::cout << "insert: " << std::setw(8) << single_ms << " ms  insert_batch: " << std::setw(8) << batch_ms << " ms" << std::endl;
+    std::cout << "find:   " << std::setw(8) << find_ms << " ms  find_batch:   " << std::setw(8) << find_batch_ms << " ms" << std::endl;
+    ASSERT_EQ(sum, values.sum());
+
+    // 排序后共享前缀下降: 随机查询和集中在一个小区域的查询
+    Eigen::Matrix3Xd local = (cloud * 0.1).colwise() + Eigen::Vector3d(40, 40, 40);
+    std::vector<Tree::Node*> nodes(cloud.cols());
+    for (const Eigen::Matrix3Xd *queries : {&cloud, &local}) {
+        double each_ms = time_ms([&]() {
+            for (Eigen::Index j = 0; j < queries->cols(); ++j) nodes[j] = batch.find(queries->col(j));
+        });
+        double interleaved_ms = time_ms([&]() { batch.find_batch(*queries, nodes.data(), batch.max_depth()); });
+        double sorted_ms = time_ms([&]() { batch.find_sorted(*queries, nodes.data(), batch.max_depth()); });
+        std::cout << (queries == &cloud ? "random" : "local ") << " find: " << std::setw(8) << each_ms << " ms  find_batch: "
+                  << std::setw(8) << interleaved_ms << " ms  find_sorted: " << std::setw(8) << sorted_ms << " ms" << std::endl;
+        ASSERT_EQ(nodes[7], batch.find(queries->col(7)));
+    }
+}
+
+SKIP_TEST(octree_bench, static_depth)
+{
+    std::vector<Point> points = random_points(100000, 8), queries = random_points(100000, 9);
+    Tree tree(Point(0, 0, 0), Point(100, 100, 100), 9);
+    StaticOctTree<Point, float, 9> fixed(Point(0, 0, 0), Point(100, 100, 100));
+    for (const Point& p : points) {
+        tree.insert(p, 1);
+        fixed.insert(p, 1);
+    }
+
+    float sum = 0, fixed_sum = 0;
+    Tree::Key keys = 0, fixed_keys = 0;
+    double find_ms = time_ms([&]() {
+        for (const Point& q : queries) sum += tree.find(q)->data;
+    });
+    double fixed_find_ms = time_ms([&]() {
+        for (const Point& q : queries) fixed_sum += fixed.find(q)->data;
+    });
+    double key_ms = time_ms([&]() {
+        for (const Point& q : queries) keys += tree.find_key(q, 8);
+    });
+    double fixed_key_ms = time_ms([&]() {
+        for (const Point& q : queries) fixed_keys += fixed.find_key(q);
+    });
+    std::cout << "find:     runtime " << std::setw(8) << find_ms << " ms  static " << std::setw(8) << fixed_find_ms << " ms" << std::endl;
+    std::cout << "find_key: runtime " << std::setw(8) << key_ms << " ms  static " << std::setw(8) << fixed_key_ms << " ms" << std::endl;
+    ASSERT_EQ(sum, fixed_sum);
+    ASSERT_EQ(keys, fixed_keys);
+}
+
+SKIP_TEST(octree_bench, radix_sort)
+{
+    // 100 万个点的第 8 层编码(24 位有效), 以及完整的 64 位随机键
+    Tree tree(Point(0, 0, 0), Point(100, 100, 100), 9);
+    std::vector<Point> points = random_points(1000000, 12);
+    std::mt19937_64 rng(13);
+    std::vector<Tree::Key> morton(points.size()), full(points.size());
+    for (size_t j = 0; j < points.size(); ++j) {
+        morton[j] = tree.find_key(points[j], 8);
+        full[j] = rng();
+    }
+
+    for (const std::vector<Tree::Key> *input : {&morton, &full}) {
+        size_t bits = input == &morton ? 24 : 64;
+        std::vector<std::pair<Tree::Key, uint32_t>> pairs(input->size());
+        for (size_t j = 0; j < pairs.size(); ++j) pairs[j] = std::make_pair((*input)[j], uint32_t(j));
+        double std_ms = time_ms([&]() { std::sort(pairs.begin(), pairs.end()); });
+
+        std::vector<Tree::Key> keys = *input;
+        std::vector<uint32_t> ids(keys.size());
+        for (size_t j = 0; j < ids.size(); ++j) ids[j] = uint32_t(j);
+        double radix_ms = time_ms([&]() { radix_sort(keys.data(), ids.data(), keys.size(), bits); });
+
+        std::vector<Tree::Key> keys4 = *input;
+        std::vector<uint32_t> ids4(keys4.size());
+        for (size_t j = 0; j < ids4.size(); ++j) ids4[j] = uint32_t(j);
+        double radix4_ms = time_ms([&]() { radix_sort(keys4.data(), ids4.data(), keys4.size(), bits, 4); });
+
+        std::cout << std::setw(2) << bits << " bit  std::sort: " << std::setw(8) << std_ms << " ms  radix_sort: " << std::setw(8) << radix_ms
+                  << " ms  radix_sort(4 threads): " << std::setw(8) << radix4_ms << " ms" << std::endl;
+        ASSERT_TRUE(keys[1234] == pairs[1234].first && ids[1234] == pairs[1234].second);
+        ASSERT_TRUE(keys4 == keys && ids4 == ids);
+    }
+}
@@ -0,0 +1,131 @@
+#include "core/tt_test.h"
+#include "octree/octree_codec.h"
+#include <Eigen/Core>
+#include <sstream>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+using Point = Eigen::Vector3d;
+using Tree = OctTree<Point, float>;
+using Codec = OctreeCodec<Point, float, 3>;
+
+static size_t count_nodes(Tree& tree, size_t* max_depth = nullptr)
+{
+    size_t count = 0;
+    tree.visual([&](Tree::Node* node) {
+        ++count;
+        if (max_depth && node->depth > *max_depth) *max_depth = node->depth;
+    });
+    return count;
+}
+
+TEST(octree_codec, test)
+{
+    Tree tree(Point(0, 0, 0), Point(64, 64, 64), 7);
+    for (int i = 0; i < 5000; ++i) tree.insert(Point((i * 13) % 64, (i * 29) % 64, (i * 7) % 64), 1.5f);
+
+    // 无损编码, 码流远小于完整保存
+    Codec::Options options;
+    std::vector<uint8_t> stream = Codec::encode(tree, options);
+    std::ostringstream full;
+    tree.save(full);
+    ASSERT_LT(stream.size(), full.str().size());
+
+    Tree decoded(Point(0, 0, 0), Point(1, 1, 1), 1);
+    ASSERT_TRUE(Codec::decode(stream, decoded));
+    ASSERT_TRUE(decoded.diff(tree).empty());
+    ASSERT_EQ(decoded.find(Point(13, 29, 7))->center, tree.find(Point(13, 29, 7))->center);
+
+    // 只有结构: 每个非叶子节点 1 字节
+    options.payload = Codec::Payload::NONE;
+    std::vector<uint8_t> structure = Codec::encode(tree, options);
+    ASSERT_LT(structure.size(), stream.size() / 3);
+
+    // 量化数据
+    options.payload = Codec::Payload::QUANTIZED8;
+    ASSERT_TRUE(Codec::decode(Codec::encode(tree, options), decoded));
+    ASSERT_EQ(count_nodes(decoded), count_nodes(tree));
+    float error = std::fabs(decoded.find(Point(13, 29, 7), 1)->data - tree.find(Point(13, 29, 7), 1)->data);
+    ASSERT_LT(error, tree.find(Point(13, 29, 7), 1)->data / 100);
+
+    // 限制深度和区域
+    options.payload = Codec::Payload::RAW;
+    options.depth = 3;
+    ASSERT_TRUE(Codec::decode(Codec::encode(tree, options), decoded));
+    size_t depth = 0;
+    count_nodes(decoded, &depth);
+    ASSERT_EQ(depth, 3u);
+    ASSERT_EQ(decoded.find(Point(13, 29, 7))->data, tree.find(Point(13, 29, 7), 3)->data);
+
+    options.depth = 0;
+    options.use_region = true;
+    options.region = Tree::Boundary(Point(0, 0, 0), Point(20, 20, 20));
+    ASSERT_TRUE(Codec::decode(Codec::encode(tree, options), decoded));
+    ASSERT_LT(count_nodes(decoded), count_nodes(tree));
+    ASSERT_EQ(decoded.find(Point(5, 5, 5))->data, tree.find(Point(5, 5, 5))->data);
+    ASSERT_EQ(decoded.find(Point(60, 60, 60))->depth, 0u);
+}
+
+TEST(octree_codec, invalid)
+{
+    Tree tree(Point(0, 0, 0), Point(64, 64, 64), 7);
+    for (int i = 0; i < 500; ++i) tree.insert(Point((i * 13) % 64, (i * 29) % 64, (i * 7) % 64), 1.5f);
+    std::vector<uint8_t> stream = Codec::encode(tree);
+    Tree decoded(Point(0, 0, 0), Point(1, 1, 1), 1);
+    ASSERT_TRUE(Codec::decode(stream, decoded));
+
+    // 头部: magic(4) dim(1) payload(1) max_depth(4) depth(4)
+    auto patched = [&stream](size_t offset, uint32_t value) {
+        std::vector<uint8_t> bad = stream;
+        std::memcpy(bad.data() + offset, &value, sizeof(value));
+        return bad;
+    };
+    ASSERT_FALSE(Codec::decode(patched(6, 1000), decoded));                 // 最大深度超过半尺寸表
+    ASSERT_FALSE(Codec::decode(patched(10, 7), decoded));                   // 节点深度不小于最大深度
+    ASSERT_FALSE(Codec::decode(patched(10, 1000), decoded));
+    ASSERT_EQ(count_nodes(decoded), count_nodes(tree));                     // 失败时不修改 tree
+
+    // 数据类型不支持所选的编码方式时编码为空, 不会静默丢失数据; 只编码结构时仍可用
+    using Labels = OctTree<Point, std::string>;
+    using LabelCodec = OctreeCodec<Point, std::string, 3>;
+    Labels labels(Point(0, 0, 0), Point(64, 64, 64), 4);
+    labels.insert(Point(1, 2, 3), "door");
+    ASSERT_FALSE(LabelCodec::supports(LabelCodec::Payload::RAW));
+    ASSERT_FALSE(LabelCodec::supports(LabelCodec::Payload::QUANTIZED8));
+    ASSERT_TRUE(LabelCodec::encode(labels).empty());
+    LabelCodec::Options options;
+    options.payload = LabelCodec::Payload::NONE;
+    Labels structure(Point(0, 0, 0), Point(1, 1, 1), 1);
+    ASSERT_TRUE(LabelCodec::decode(LabelCodec::encode(labels, options), structure));
+    ASSERT_EQ(structure.find(Point(1, 2, 3))->depth, 3u);
+}
+
+TEST(octree_codec, coord_type)
+{
+    // 定点内部坐标的树与默认坐标的树码流相同, 可以互相解码
+    using FixedTree = Octree<Point, float, 3, PointerRef, Eigen::Vector3i>;
+    using FixedCodec = OctreeCodec<Point, float, 3, PointerRef, Eigen::Vector3i>;
+    Tree tree(Point(0, 0, 0), Point(64, 64, 64), 7);
+    FixedTree fixed(Point(0, 0, 0), Point(64, 64, 64), 7);
+    for (int i = 0; i < 2000; ++i) {
+        Point p((i * 13) % 64 + 0.5, (i * 29) % 64 + 0.5, (i * 7) % 64 + 0.5);
+        tree.insert(p, 1.5f);
+        fixed.insert(p, 1.5f);
+    }
+    std::vector<uint8_t> stream = FixedCodec::encode(fixed);
+    ASSERT_TRUE(stream == Codec::encode(tree));
+
+    FixedTree decoded(Point(0, 0, 0), Point(1, 1, 1), 1);
+    ASSERT_TRUE(FixedCodec::decode(stream, decoded));
+    ASSERT_TRUE(decoded.diff(fixed).empty());
+    ASSERT_EQ(decoded.find(Point(13.5, 29.5, 7.5))->data, tree.find(Point(13.5, 29.5, 7.5))->data);
+
+    // 定点坐标最多 28 层, 更深的码流被拒绝
+    ASSERT_EQ(FixedTree(Point(0, 0, 0), Point(1, 1, 1), 40).max_depth(), 28u);
+    uint32_t max_depth = 29;
+    std::memcpy(stream.data() + 6, &max_depth, sizeof(max_depth));
+    ASSERT_FALSE(FixedCodec::decode(stream, decoded));
+    Tree deep(Point(0, 0, 0), Point(1, 1, 1), 1);
+    ASSERT_TRUE(Codec::decode(stream, deep));
+}
@@ -0,0 +1,113 @@
+#include "core/tt_test.h"
+#include "octree/octree_pipeline.h"
+#include <Eigen/Core>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using Point = Eigen::Vector2d;
+using Pipeline = OctreePipeline<Point, double, 2>;
+
+static double snapshot_total(const Pipeline::Snapshot& snapshot)
+{
+    double total = 0;
+    snapshot.visual([&total](const Pipeline::Snapshot::Node* node) {
+        if (node->depth == 1) total += node->data;
+    });
+    return total;
+}
+
+TEST(octree_pipeline, test)
+{
+    Pipeline pipeline(Point(0, 0), Point(64, 64), 5, 256, 10);
+
+    const size_t producer_num = 4;
+    const size_t point_num = 2000;
+    const double expect = double(producer_num * point_num);
+
+    // 读线程在建图期间持续查询副本: 每个副本内部一致, 后发布的副本包含的点不会变少
+    std::atomic<bool> done(false), consistent(true);
+    std::atomic<size_t> reads(0);
+    std::thread reader([&]() {
+        double last = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            std::shared_ptr<const Pipeline::Snapshot> snapshot = pipeline.snapshot();
+            double total = snapshot_total(*snapshot);
+            const Pipeline::Snapshot::Node *node = snapshot->find(Point(1, 7));
+            if (snapshot == nullptr || total < last || total > expect || node == nullptr || node->depth > 4) consistent = false;
+            last = total;
+            reads.fetch_add(1, std::memory_order_release);
+        }
+    });
+    while (reads.load(std::memory_order_acquire) == 0) std::this_thread::yield();
+
+    std::vector<std::thread> producers;
+    for (size_t p = 0; p < producer_num; ++p) {
+        producers.emplace_back([&pipeline, p]() {
+            for (size_t i = 0; i < point_num; ++i) {
+                pipeline.push(Point(double(i % 64), double((i * 7 + p) % 64)), 1);
+            }
+        });
+    }
+    for (auto &producer : producers) producer.join();
+
+    ASSERT_TRUE(pipeline.flush());
+    size_t reads_before = reads.load(std::memory_order_acquire);
+    while (reads.load(std::memory_order_acquire) < reads_before + 2) std::this_thread::yield();
+    done = true;
+    reader.join();
+    ASSERT_TRUE(consistent.load());
+
+    std::shared_ptr<const Pipeline::Snapshot> snapshot = pipeline.snapshot();
+    ASSERT_EQ(snapshot_total(*snapshot), expect);
+    const Pipeline::Snapshot::Node *node = snapshot->find(Point(1, 7));
+    ASSERT_EQ(node->depth, 4u);
+    ASSERT_GT(node->data, 0);
+
+    // 停止后提交的点不会再被处理, flush 直接返回失败而不是一直等待
+    pipeline.stop();
+    pipeline.push(Point(1, 7), 1);
+    ASSERT_FALSE(pipeline.flush());
+    ASSERT_EQ(snapshot_total(*pipeline.snapshot()), expect);
+}
+
+TEST(octree_pipeline, coord_type)
+{
+    // 可写树使用 float 内部坐标, 副本仍按 PosType 查询
+    OctreePipeline<Point, double, 2, Eigen::Vector2f> pipeline(Point(0, 0), Point(64, 64), 5, 64, 10);
+    for (int i = 0; i < 500; ++i) pipeline.push(Point((i * 13) % 64 + 0.5, (i * 29) % 64 + 0.5), 1);
+    pipeline.flush();
+
+    Octree<Point, double, 2> expect(Point(0, 0), Point(64, 64), 5);
+    for (int i = 0; i < 500; ++i) expect.insert(Point((i * 13) % 64 + 0.5, (i * 29) % 64 + 0.5), 1);
+    auto snapshot = pipeline.snapshot();
+    ASSERT_EQ(snapshot->size(), expect.size());
+    ASSERT_EQ(snapshot->find(Point(13.5, 29.5))->center, expect.find(Point(13.5, 29.5))->center);
+    ASSERT_EQ(snapshot->find(Point(13.5, 29.5))->data, expect.find(Point(13.5, 29.5))->data);
+}
+
+TEST(octree_pipeline, bounded_queue)
+{
+    // 队列单元预先分配, 满时 push 立即失败, 已入队的点按顺序取出
+    MpscQueue<int> queue(3);
+    ASSERT_EQ(queue.capacity(), 4u);
+    for (int i = 0; i < 4; ++i) ASSERT_TRUE(queue.push(i));
+    ASSERT_FALSE(queue.push(4));
+    int value = -1;
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_EQ(value, 0);
+    ASSERT_TRUE(queue.push(4));
+    for (int i = 1; i <= 4; ++i) {
+        ASSERT_TRUE(queue.pop(value));
+        ASSERT_EQ(value, i);
+    }
+    ASSERT_TRUE(queue.empty());
+
+    // 建图线程停止后队列不再被取出, 超出容量的点被丢弃并计数
+    Pipeline pipeline(Point(0, 0), Point(64, 64), 5, 256, 10, 4);
+    pipeline.stop();
+    for (int i = 0; i < 4; ++i) ASSERT_TRUE(pipeline.push(Point(1, 7), 1));
+    ASSERT_FALSE(pipeline.push(Point(1, 7), 1));
+    ASSERT_EQ(pipeline.dropped(), 1u);
+}
@@ -1,11 +1,17 @@
 #include "core/tt_test.h"
 #include "core/tt_assert.h"
 #include "octree/octree.h"
+#include "octree/linear_octree.h"
+#include "octree/occupancy_octree.h"
 #include "plot/plot_manage.h"
 #include <Eigen/Core>
 #include <iostream>
+#include <cstring>
 #include <sstream>
 #include <fstream>
+#include <algorithm>
+#include <iterator>
+#include <memory>
 
 using Point = Eigen::Vector2d;
 using Quad = QuadTree<Point, double>;
@@ -76,6 +82,701 @@ TEST(octree, test)
     plot.write("quadtree.svg");
 }
 
+template <typename Tree>
+static std::vector<std::pair<Point, double>> dump(Tree& tree)
+{
+    std::vector<std::pair<Point, double>> nodes;
+    tree.visual([&nodes](typename Tree::Node* node) { nodes.emplace_back(node->center, node->data); });
+    return nodes;
+}
+
+TEST(octree, clone)
+{
+    Quad quadtree(Point(0, 0), Point(64, 64), 6);
+    for (int i = 0; i < 500; ++i) quadtree.insert(Point((i * 13) % 64, (i * 29) % 64), 1);
+
+    Quad copy = quadtree.clone();
+    ASSERT_TRUE(dump(copy) == dump(quadtree));
+
+    // 拷贝与原树互不影响
+    copy.insert(Point(1, 1), 100);
+    ASSERT_FALSE(dump(copy) == dump(quadtree));
+
+    std::vector<std::pair<Point, double>> before = dump(quadtree);
+    Quad moved(std::move(quadtree));
+    ASSERT_TRUE(dump(moved) == before);
+
+    double data = copy.find(Point(1, 1))->data;
+    moved = std::move(copy);
+    ASSERT_EQ(moved.find(Point(1, 1))->data, data);
+    ASSERT_GE(data, 100);
+}
+
+TEST(octree, merge_diff)
+{
+    Quad a(Point(0, 0), Point(64, 64), 6), b(Point(0, 0), Point(64, 64), 6);
+    Quad all(Point(0, 0), Point(64, 64), 6), a_copy(Point(0, 0), Point(64, 64), 6);
+    for (int i = 0; i < 300; ++i) {
+        Point p((i * 13) % 64, (i * 29) % 32);
+        Point q((i * 7) % 64, 16 + (i * 11) % 48);
+        a.insert(p, 1);
+        a_copy.insert(p, 1);
+        b.insert(q, 2);
+        all.insert(p, 1);
+        all.insert(q, 2);
+    }
+
+    // 增量: a_copy 应用差异后与 all 相同
+    std::vector<Quad::NodeDiff> diffs = diff(a_copy, all);
+    ASSERT_FALSE(diffs.empty());
+    a_copy.apply(diffs);
+    ASSERT_TRUE(dump(a_copy) == dump(all));
+    ASSERT_TRUE(a_copy.diff(all).empty());
+
+    // 反向差异包含删除的子树
+    Quad reverted = all.clone();
+    reverted.apply(all.diff(a));
+    ASSERT_TRUE(dump(reverted) == dump(a));
+
+    Quad merged = merge(std::move(a), std::move(b));
+    ASSERT_TRUE(dump(merged) == dump(all));
+}
+
+TEST(octree, index_ref)
+{
+    using IndexQuad = Octree<Point, double, 2, IndexRef>;
+    ASSERT_LT(sizeof(IndexQuad::Node), sizeof(Quad::Node));
+
+    Quad a(Point(0, 0), Point(64, 64), 6), b(Point(0, 0), Point(64, 64), 6);
+    IndexQuad ia(Point(0, 0), Point(64, 64), 6), ib(Point(0, 0), Point(64, 64), 6);
+    for (int i = 0; i < 2000; ++i) {
+        Point p((i * 13) % 64, (i * 29) % 32), q((i * 7) % 64, 16 + (i * 11) % 48);
+        a.insert(p, 1);
+        ia.insert(p, 1);
+        b.insert(q, 2);
+        ib.insert(q, 2);
+    }
+    ASSERT_TRUE(dump(ia) == dump(a));
+    ASSERT_EQ(ia.find(Point(10, 10))->data, a.find(Point(10, 10))->data);
+
+    // 拷贝、合并会拼接内存池, 拼接进来的下标需要加上偏移
+    IndexQuad ic = ia.clone();
+    ASSERT_TRUE(dump(ic) == dump(a));
+    IndexQuad merged = merge(std::move(ic), ib.clone());
+    Quad expect = merge(a.clone(), b.clone());
+    ASSERT_TRUE(dump(merged) == dump(expect));
+
+    merged.coarsen(merged.size() / 2 * sizeof(IndexQuad::Node));
+    merged.apply(merged.diff(ia));
+    ASSERT_TRUE(dump(merged) == dump(a));
+
+    // 镜像按字节拷贝到另一块(不对齐的)内存后恢复, 下标引用不需要修正; 索引在恢复后重建
+    std::vector<uint8_t> image = merged.export_image();
+    std::vector<uint8_t> moved(image.size() + 1);
+    std::memcpy(moved.data() + 1, image.data(), image.size());
+    IndexQuad restored(Point(0, 0), Point(1, 1), 1);
+    restored.set_hash_index(true);
+    ASSERT_TRUE(restored.import_image(moved.data() + 1, image.size()));
+    ASSERT_TRUE(dump(restored) == dump(a));
+    ASSERT_EQ(restored.find(Point(10, 10))->data, a.find(Point(10, 10))->data);
+    ASSERT_TRUE(restored.export_image() == image);
+    restored.insert(Point(63.5, 63.5), 1);
+    merged.insert(Point(63.5, 63.5), 1);
+    ASSERT_TRUE(dump(restored) == dump(merged));
+
+    // 不完整或引用越界的镜像被拒绝, 树不变
+    ASSERT_FALSE(restored.import_image(image.data(), image.size() - 1));
+    std::vector<uint8_t> bad = image;
+    uint32_t root = 0xfffffff0u;
+    std::memcpy(bad.data() + 16, &root, sizeof(root));
+    ASSERT_FALSE(restored.import_image(bad.data(), bad.size()));
+    bad = image;
+    std::memset(bad.data() + bad.size() - image.size() / 2, 0xab, image.size() / 2);
+    ASSERT_FALSE(restored.import_image(bad.data(), bad.size()));
+    ASSERT_TRUE(dump(restored) == dump(merged));
+
+    IndexQuad ia_ib = unite(ia, ib);
+    Quad a_b = unite(a, b);
+    ASSERT_TRUE(dump(ia_ib) == dump(a_b));
+}
+
+TEST(octree, optimize_layout)
+{
+    Quad quadtree(Point(0, 0), Point(64, 64), 7);
+    for (int i = 0; i < 3000; ++i) quadtree.insert(Point((i * 37) % 64 + 0.5, (i * 53) % 64 + 0.5), 1);
+    std::vector<std::pair<Point, double>> expect = dump(quadtree);
+
+    for (Quad::Layout layout : {Quad::Layout::DFS, Quad::Layout::BFS, Quad::Layout::VEB, Quad::Layout::HILBERT}) {
+        Quad tree = quadtree.clone();
+        tree.optimize_layout(layout);
+        ASSERT_TRUE(dump(tree) == expect);
+        ASSERT_EQ(tree.size(), quadtree.size());
+        ASSERT_EQ(tree.find(Point(10.5, 20.5))->data, quadtree.find(Point(10.5, 20.5))->data);
+    }
+
+    // 前序排列后, 第一个子节点紧跟在父节点之后
+    quadtree.compact();
+    const Quad::Node *root = quadtree.root();
+    size_t first = 0;
+    while (quadtree.child(root, first) == nullptr) ++first;
+    ASSERT_TRUE(quadtree.child(root, first) == root + 1);
+}
+
+TEST(octree, hilbert)
+{
+    // 4 层网格上 Hilbert 编码是一一映射, 且相邻编码的格子相邻
+    const size_t depth = 4, side = 1 << depth;
+    std::vector<Point> cells(side * side, Point(-1, -1));
+    for (uint64_t key = 0; key < side * side; ++key) {
+        Point cell(0, 0);
+        for (size_t level = 0; level < depth; ++level) {
+            uint64_t digit = key >> (2 * (depth - 1 - level));
+            cell += Point(double(digit & 1), double((digit >> 1) & 1)) * double(1 << (depth - 1 - level));
+        }
+        uint64_t h = morton_to_hilbert<2>(key, depth);
+        ASSERT_LT(h, side * side);
+        ASSERT_EQ(cells[h][0], -1.0);
+        cells[h] = cell;
+    }
+    for (size_t h = 1; h < cells.size(); ++h) ASSERT_EQ((cells[h] - cells[h - 1]).lpNorm<1>(), 1.0);
+
+    // 满树按 HILBERT 重排后, 叶子的存储顺序(下标引用即分配顺序)就是 Hilbert 序, 相邻叶子在空间上相邻
+    using IndexQuad = Octree<Point, double, 2, IndexRef>;
+    IndexQuad quadtree(Point(0, 0), Point(16, 16), depth + 1);
+    for (size_t x = 0; x < side; ++x) {
+        for (size_t y = 0; y < side; ++y) quadtree.insert(Point(x + 0.5, y + 0.5), double(x * side + y));
+    }
+    quadtree.optimize_layout(IndexQuad::Layout::HILBERT);
+    std::vector<std::pair<uint32_t, Point>> stored;
+    quadtree.visual([&stored](IndexQuad::Node *node) {
+        if (node->depth + 1 != depth) return;
+        for (size_t i = 0; i < IndexQuad::child_num_; ++i) {
+            stored.emplace_back(node->childs.get(i), node->center + Point(i & 1 ? 0.5 : -0.5, i & 2 ? 0.5 : -0.5));
+        }
+    });
+    ASSERT_EQ(stored.size(), side * side);
+    std::sort(stored.begin(), stored.end(), [](const std::pair<uint32_t, Point>& a, const std::pair<uint32_t, Point>& b) { return a.first < b.first; });
+    std::vector<Point> leaves;
+    for (const auto& leaf : stored) leaves.push_back(leaf.second);
+    for (size_t k = 1; k < leaves.size(); ++k) ASSERT_EQ((leaves[k] - leaves[k - 1]).lpNorm<1>(), 1.0);
+
+    // 父节点的 Hilbert 编码是子节点编码的前缀
+    for (const Point& p : leaves) {
+        ASSERT_EQ(quadtree.hilbert_key(p, 2), quadtree.hilbert_key(p, 4) >> 4);
+        ASSERT_EQ(quadtree.find(p)->center, p);
+    }
+
+    // 线性副本按 Hilbert 序排列兄弟节点, 查找结果不变
+    LinearOctree<Point, double, 2> morton(quadtree), hilbert(quadtree, Curve::HILBERT);
+    ASSERT_EQ(morton.size(), hilbert.size());
+    for (const Point& p : leaves) {
+        ASSERT_EQ(hilbert.find(p)->data, morton.find(p)->data);
+        ASSERT_EQ(hilbert.find(p, 2)->center, morton.find(p, 2)->center);
+    }
+    std::vector<Point> order;
+    hilbert.visual([&order](const LinearOctree<Point, double, 2>::Node *node) { if (node->depth == depth) order.push_back(node->center); });
+    for (size_t k = 1; k < order.size(); ++k) ASSERT_EQ((order[k] - order[k - 1]).lpNorm<1>(), 1.0);
+}
+
+TEST(octree, dense_levels)
+{
+    Quad quadtree(Point(0, 0), Point(64, 64), 7), dense(Point(0, 0), Point(64, 64), 7);
+    dense.set_dense_levels(3);
+    for (int i = 0; i < 2000; ++i) {
+        Point p((i * 37) % 64 + 0.5, (i * 53) % 48 + 0.5);
+        quadtree.insert(p, 1);
+        dense.insert(p, 1);
+    }
+
+    // 稠密层以下缺失的区域返回路径上最深的节点, 与逐层下降相同
+    for (int i = 0; i < 500; ++i) {
+        Point q((i * 7) % 70 - 3.0, (i * 11) % 70 - 3.0);
+        for (size_t depth : {0, 2, 3, 5, 7}) {
+            ASSERT_EQ(dense.find(q, depth)->depth, quadtree.find(q, depth)->depth);
+            ASSERT_EQ(dense.find(q, depth)->data, quadtree.find(q, depth)->data);
+        }
+    }
+    Quad::Key key = quadtree.find_key(Point(10.5, 60.5), 5);
+    ASSERT_TRUE(dense.find_by_key(key, 5) == nullptr);
+
+    // 结构修改后索引按需重建
+    dense.coarsen(dense.size() / 2 * sizeof(Quad::Node));
+    quadtree.coarsen(quadtree.size() / 2 * sizeof(Quad::Node));
+    dense.insert(Point(10.5, 60.5), 1);
+    quadtree.insert(Point(10.5, 60.5), 1);
+    ASSERT_TRUE(dense.find_by_key(key, 5) != nullptr);
+    for (int i = 0; i < 500; ++i) {
+        Point q((i * 7) % 64 + 0.5, (i * 11) % 64 + 0.5);
+        ASSERT_EQ(dense.find(q)->depth, quadtree.find(q)->depth);
+    }
+}
+
+TEST(octree, hash_index)
+{
+    Quad quadtree(Point(0, 0), Point(64, 64), 8), hashed(Point(0, 0), Point(64, 64), 8);
+    hashed.set_hash_index(true);
+    for (int i = 0; i < 2000; ++i) {
+        Point p((i * 37) % 64 + 0.25, (i * 53) % 48 + 0.25);
+        quadtree.insert(p, 1);
+        hashed.insert(p, 1);
+    }
+
+    for (int i = 0; i < 500; ++i) {
+        Point q((i * 7) % 64 + 0.25, (i * 11) % 64 + 0.25);
+        for (size_t depth : {0, 1, 4, 7, 8}) {
+            ASSERT_TRUE(hashed.find(q, depth)->center == quadtree.find(q, depth)->center);
+            ASSERT_EQ(hashed.find(q, depth)->depth, quadtree.find(q, depth)->depth);
+        }
+        Quad::Key key = hashed.find_key(q, 6);
+        Quad::Node *node = hashed.find_by_key(key, 6);
+        ASSERT_EQ(node != nullptr, quadtree.find_by_key(key, 6) != nullptr);
+        if (node != nullptr) ASSERT_EQ(hashed.find_key(node->center, 6), key);
+    }
+
+    // 合并后索引重建
+    hashed.coarsen(hashed.size() / 2 * sizeof(Quad::Node));
+    Quad plain = hashed.clone();
+    plain.set_hash_index(false);
+    for (int i = 0; i < 500; ++i) {
+        Point q((i * 7) % 64 + 0.25, (i * 11) % 64 + 0.25);
+        ASSERT_EQ(hashed.find(q)->depth, plain.find(q)->depth);
+    }
+}
+
+static std::vector<std::pair<double, double>> leaves(Quad& tree)
+{
+    std::vector<std::pair<double, double>> cells;
+    tree.visual([&](Quad::Node* node) {
+        if (node->depth + 1 == tree.max_depth()) cells.emplace_back(node->center[0], node->center[1]);
+    });
+    std::sort(cells.begin(), cells.end());
+    return cells;
+}
+
+TEST(octree, coord_type)
+{
+    using FloatQuad = Octree<Point, double, 2, PointerRef, Eigen::Vector2f>;
+    using FixedQuad = Octree<Point, double, 2, PointerRef, Eigen::Matrix<int32_t, 2, 1>>;
+    Quad quadtree(Point(-50, -50), Point(50, 50), 8);
+    FloatQuad float_tree(Point(-50, -50), Point(50, 50), 8);
+    FixedQuad fixed_tree(Point(-50, -50), Point(50, 50), 8);
+    // 离格子边界足够远的点, 三种坐标的结果应完全相同(边界附近的点会因量化落到相邻格子)
+    std::vector<Point> points;
+    for (int i = 0; i < 2000; ++i) points.emplace_back((i * 37) % 997 / 10.0 - 49.83, (i * 53) % 991 / 10.0 - 49.53);
+    for (const Point& p : points) {
+        quadtree.insert(p, 1);
+        float_tree.insert(p, 1);
+        fixed_tree.insert(p, 1);
+    }
+    ASSERT_EQ(float_tree.size(), quadtree.size());
+    ASSERT_EQ(fixed_tree.size(), quadtree.size());
+
+    for (const Point& p : points) {
+        Quad::Node *node = quadtree.find(p);
+        FloatQuad::Node *float_node = float_tree.find(p);
+        FixedQuad::Node *fixed_node = fixed_tree.find(p);
+        ASSERT_EQ(float_node->depth, node->depth);
+        ASSERT_EQ(fixed_node->depth, node->depth);
+        ASSERT_EQ(float_node->data, node->data);
+        ASSERT_EQ(fixed_node->data, node->data);
+        ASSERT_LT((fixed_tree.position(fixed_node) - node->center).norm(), 1e-6);
+        ASSERT_EQ(fixed_tree.find_key(p, 7), quadtree.find_key(p, 7));
+    }
+
+    size_t count = 0, float_count = 0, fixed_count = 0;
+    quadtree.query_box(Point(-20, -10), Point(15, 30), [&count](Quad::Node*) { ++count; });
+    float_tree.query_box(Point(-20, -10), Point(15, 30), [&float_count](FloatQuad::Node*) { ++float_count; });
+    fixed_tree.query_box(Point(-20, -10), Point(15, 30), [&fixed_count](FixedQuad::Node*) { ++fixed_count; });
+    ASSERT_EQ(float_count, count);
+    ASSERT_EQ(fixed_count, count);
+
+    // 超出边界(以及超出定点数范围)的查询框被截断, 结果与 double 坐标相同
+    std::vector<std::pair<Point, Point>> boxes = {{Point(-1e12, -1e12), Point(1e12, 1e12)}, {Point(-1e12, -10), Point(0, 1e15)},
+                                                  {Point(-1e12, -1e12), Point(-1e11, -1e11)}, {Point(60, -1e20), Point(1e20, 1e20)}};
+    for (const auto& box : boxes) {
+        count = fixed_count = 0;
+        quadtree.query_box(box.first, box.second, [&count](Quad::Node*) { ++count; });
+        fixed_tree.query_box(box.first, box.second, [&fixed_count](FixedQuad::Node*) { ++fixed_count; });
+        ASSERT_EQ(fixed_count, count);
+    }
+
+    count = fixed_count = 0;
+    quadtree.query_radius(Point(3, 4), 12, [&count](Quad::Node*) { ++count; });
+    fixed_tree.query_radius(Point(3, 4), 12, [&fixed_count](FixedQuad::Node*) { ++fixed_count; });
+    ASSERT_EQ(fixed_count, count);
+
+    // 节点中心变小, 节点也变小
+    ASSERT_LT(sizeof(FloatQuad::Node), sizeof(Quad::Node));
+    ASSERT_LT(sizeof(FixedQuad::Node), sizeof(Quad::Node));
+
+    // 线性副本把内部坐标转换回 PosType
+    LinearOctree<Point, double, 2> linear(quadtree), fixed_linear(fixed_tree);
+    ASSERT_EQ(fixed_linear.size(), linear.size());
+    for (const Point& p : points) {
+        ASSERT_LT((fixed_linear.find(p)->center - linear.find(p)->center).norm(), 1e-6);
+        ASSERT_EQ(fixed_linear.find(p)->data, linear.find(p)->data);
+    }
+
+    // 定点坐标最多 28 层
+    ASSERT_EQ(FixedQuad(Point(-50, -50), Point(50, 50), 40).max_depth(), 28u);
+}
+
+TEST(octree, deep_tree)
+{
+    // 深度超过编码长度(64 / 3 = 21 层)的八叉树, 半尺寸表同样要覆盖到叶子
+    using Point3 = Eigen::Vector3d;
+    using Oct = OctTree<Point3, float>;
+    Oct tree(Point3(0, 0, 0), Point3(1, 1, 1), 26);
+    std::vector<Point3> points = {Point3(0.1, 0.2, 0.3), Point3(0.7, 0.01, 0.99), Point3(0.5001, 0.4999, 0.25)};
+    for (const Point3& p : points) tree.insert(p, 1);
+    for (const Point3& p : points) {
+        Oct::Node *node = tree.find(p);
+        ASSERT_EQ(node->depth, 25u);
+        Oct::Boundary boundary(p, p);
+        tree.find_boundary(node, boundary);
+        ASSERT_TRUE(boundary.is_in(p));
+        ASSERT_LT((boundary.max - boundary.min).maxCoeff(), 1.0 / (1 << 24));
+    }
+    float sum = 0;
+    tree.query_box(Point3(0, 0, 0), Point3(0.6, 0.6, 0.6), [&sum](Oct::Node *node) { if (node->depth == 25) sum += node->data; });
+    ASSERT_EQ(sum, 2.0f);
+    std::vector<Oct::Node*> nodes(points.size());
+    Eigen::Matrix3Xd cloud(3, points.size());
+    for (size_t j = 0; j < points.size(); ++j) cloud.col(j) = points[j];
+    tree.find_batch(cloud, nodes.data(), tree.max_depth());
+    for (size_t j = 0; j < points.size(); ++j) ASSERT_TRUE(nodes[j] == tree.find(points[j]));
+    std::vector<Oct::Node*> sorted(points.size());
+    tree.find_sorted(cloud, sorted.data(), tree.max_depth());
+    for (size_t j = 0; j < points.size(); ++j) ASSERT_TRUE(sorted[j] == tree.find(points[j]));
+
+    // 哈希索引只到第 21 层, 更深的部分按指针下降; 建好索引后插入的节点同样可以找到
+    Oct hashed = tree.clone();
+    hashed.set_hash_index(true);
+    for (const Point3& p : points) {
+        ASSERT_EQ(hashed.find(p)->depth, 25u);
+        ASSERT_TRUE(hashed.find_by_key(hashed.find_key(p, 21), 21) == hashed.find(p, 21));
+    }
+    Point3 later(0.9, 0.9, 0.1);
+    hashed.insert(later, 2);
+    ASSERT_EQ(hashed.find(later)->depth, 25u);
+    ASSERT_EQ(hashed.find(later)->data, 2.0f);
+
+    // 差异按路径逐层记录, 深于编码长度的新增和删除都能还原
+    Oct changed = tree.clone();
+    changed.insert(Point3(0.1, 0.2, 0.3000001), 3);
+    changed.insert(Point3(0.3, 0.3, 0.3), 4);
+    Oct patched = tree.clone();
+    patched.apply(patched.diff(changed));
+    ASSERT_EQ(patched.size(), changed.size());
+    ASSERT_TRUE(patched.diff(changed).empty());
+    patched.apply(changed.diff(tree));
+    ASSERT_EQ(patched.size(), tree.size());
+    ASSERT_TRUE(patched.diff(tree).empty());
+
+    // 编码只到第 21 层: 更深的 find_key 按第 21 层计算, find_by_key 无法表示更深的节点
+    ASSERT_EQ(tree.find_key(points[0], 25), tree.find_key(points[0], 21));
+    ASSERT_TRUE(tree.find_by_key(tree.find_key(points[0], 21), 21) == tree.find(points[0], 21));
+    ASSERT_TRUE(tree.find_by_key(tree.find_key(points[0], 25), 25) == nullptr);
+
+    // 占据树在同样的深度下与 Octree 一致
+    OccupancyOctTree<Point3> occupancy(Point3(0, 0, 0), Point3(1, 1, 1), 26);
+    for (const Point3& p : points) occupancy.insert(p);
+    for (const Point3& p : points) {
+        ASSERT_EQ(occupancy.find(p).depth, 25u);
+        Oct::Boundary expect;
+        OccupancyOctTree<Point3>::Boundary boundary;
+        tree.find_boundary(tree.find(p), expect);
+        occupancy.find_boundary(occupancy.find(p), boundary);
+        ASSERT_LT((boundary.min - expect.min).norm() + (boundary.max - expect.max).norm(), 1e-12);
+    }
+
+    // Hilbert 编码只到第 21 层, 更深的子节点按子区域id排列, 重排和线性副本都保留全部节点
+    ASSERT_EQ(tree.hilbert_key(points[0], 25), tree.hilbert_key(points[0], 21));
+    Oct relayout = tree.clone();
+    relayout.optimize_layout(Oct::Layout::HILBERT);
+    ASSERT_EQ(relayout.size(), tree.size());
+    LinearOctree<Point3, float, 3> morton(tree), hilbert(tree, Curve::HILBERT);
+    ASSERT_EQ(hilbert.size(), tree.size());
+    ASSERT_EQ(morton.size(), tree.size());
+    for (const Point3& p : points) {
+        ASSERT_EQ(relayout.find(p)->depth, 25u);
+        ASSERT_EQ(relayout.find(p)->data, 1.0f);
+        ASSERT_EQ(hilbert.find(p)->depth, 25u);
+        ASSERT_TRUE(hilbert.find(p)->center == tree.find(p)->center);
+    }
+
+    // 超过上限的深度被截断; 保存的流中深度超过上限或节点比最大深度更深时拒绝加载
+    ASSERT_EQ(Oct(Point3(0, 0, 0), Point3(1, 1, 1), 1000).max_depth(), Oct::max_depth_limit_);
+    std::stringstream ss;
+    ASSERT_TRUE(tree.save(ss));
+    std::string bytes = ss.str();
+    Oct loaded(Point3(0, 0, 0), Point3(1, 1, 1), 2);
+    std::stringstream ok(bytes);
+    ASSERT_TRUE(loaded.load(ok));
+    ASSERT_EQ(loaded.find(points[0])->depth, 25u);
+    uint64_t depth = 1000;
+    bytes.replace(sizeof(uint32_t), sizeof(depth), reinterpret_cast<const char*>(&depth), sizeof(depth));
+    std::stringstream deep(bytes);
+    ASSERT_FALSE(loaded.load(deep));
+    depth = 10;
+    bytes.replace(sizeof(uint32_t), sizeof(depth), reinterpret_cast<const char*>(&depth), sizeof(depth));
+    std::stringstream shallow(bytes);
+    ASSERT_FALSE(loaded.load(shallow));
+
+    // 读到一半失败时本树不变
+    depth = 26;
+    bytes.replace(sizeof(uint32_t), sizeof(depth), reinterpret_cast<const char*>(&depth), sizeof(depth));
+    std::stringstream truncated(bytes.substr(0, bytes.size() / 2));
+    ASSERT_FALSE(loaded.load(truncated));
+    ASSERT_EQ(loaded.max_depth(), 26u);
+    ASSERT_EQ(loaded.size(), tree.size());
+    ASSERT_TRUE(loaded.diff(tree).empty());
+}
+
+TEST(octree, export_boundary)
+{
+    // 只读副本的节点边界取自源树的半尺寸表, 深度超过 31 层时也与源树一致
+    Quad quadtree(Point(-3, 5), Point(7, 6), 40);
+    Point p(1.2345, 5.4321);
+    quadtree.insert(p, 1);
+    LinearOctree<Point, double, 2> linear(quadtree);
+    for (size_t depth = 0; depth < 40; ++depth) {
+        Quad::Boundary expect, boundary;
+        quadtree.find_boundary(quadtree.find(p, depth), expect);
+        linear.find_boundary(linear.find(p, depth), boundary);
+        ASSERT_EQ(linear.find(p, depth)->depth, depth);
+        ASSERT_TRUE(boundary.min == expect.min && boundary.max == expect.max);
+    }
+}
+
+TEST(octree, batch)
+{
+    // 点云缓冲区按列存放, 通过 Map 直接传入, 不拷贝
+    std::vector<float> buffer;
+    std::vector<double> datas;
+    for (int i = 0; i < 1000; ++i) {
+        buffer.push_back(float((i * 37) % 130 - 65) / 2.0f);
+        buffer.push_back(float((i * 53) % 130 - 65) / 2.0f);
+        datas.push_back(i % 7);
+    }
+    Eigen::Map<const Eigen::Matrix2Xf> points(buffer.data(), 2, buffer.size() / 2);
+
+    Quad single(Point(-32, -32), Point(32, 32), 6), batch(Point(-32, -32), Point(32, 32), 6);
+    for (int j = 0; j < points.cols(); ++j) single.insert(points.col(j).cast<double>(), datas[j]);
+    batch.insert_batch(points, datas.data());
+    ASSERT_EQ(batch.size(), single.size());
+
+    std::vector<Quad::Node*> nodes(points.cols());
+    batch.find_batch(points, nodes.data(), 4);
+    Eigen::VectorXd values(points.cols());
+    Eigen::Matrix2Xd centers(2, points.cols());
+    batch.find_batch(points, values, centers, batch.max_depth());
+    for (int j = 0; j < points.cols(); ++j) {
+        Point p = points.col(j).cast<double>();
+        ASSERT_EQ(nodes[j]->depth, single.find(p, 4)->depth);
+        ASSERT_EQ(values[j], single.find(p)->data);
+        ASSERT_EQ((centers.col(j) - single.find(p)->center).norm(), 0.0);
+    }
+
+    std::vector<Quad::Node*> sorted(points.cols());
+    for (size_t depth : {size_t(0), size_t(3), size_t(10)}) {
+        batch.find_sorted(points, sorted.data(), depth);
+        for (int j = 0; j < points.cols(); ++j) ASSERT_EQ(sorted[j], batch.find(points.col(j).cast<double>(), depth));
+    }
+
+    // 交错下降与稠密索引的起点组合
+    batch.set_dense_levels(2);
+    batch.find_batch(points, nodes.data(), batch.max_depth());
+    for (int j = 0; j < points.cols(); ++j) ASSERT_EQ(nodes[j], batch.find(points.col(j).cast<double>()));
+
+    // 输出也可以是外部缓冲区上的 Map
+    std::vector<float> out(points.cols());
+    batch.find_batch(points, Eigen::Map<Eigen::VectorXf>(out.data(), out.size()), centers, batch.max_depth());
+    ASSERT_EQ(double(out[5]), values[5]);
+}
+
+TEST(octree, sparse_children)
+{
+    // 4 维时空索引(x, y, z, t), 子节点表为稀疏表
+    using Point4 = Eigen::Vector4d;
+    using HyperTree = Octree<Point4, double, 4>;
+    HyperTree tree(Point4(0, 0, 0, 0), Point4(16, 16, 16, 16), 5);
+    AlignedVector<Point4> points;
+    for (int i = 0; i < 2000; ++i) points.emplace_back((i * 7) % 16 + 0.5, (i * 13) % 15 + 0.5, (i * 11) % 14 + 0.5, (i * 5) % 13 + 0.5);
+    for (const Point4& p : points) tree.insert(p, 1);
+
+    for (const Point4& p : points) {
+        HyperTree::Node *node = tree.find(p);
+        ASSERT_EQ(node->depth, 4u);
+        ASSERT_LT((node->center - Point4(std::floor(p[0]) + 0.5, std::floor(p[1]) + 0.5, std::floor(p[2]) + 0.5, std::floor(p[3]) + 0.5)).norm(), 1e-9);
+    }
+
+    double total = 0;
+    tree.query_box(Point4(0, 0, 0, 0), Point4(16, 16, 16, 16), [&total](HyperTree::Node* node) { total += node->data; });
+    ASSERT_EQ(total, double(points.size()));
+
+    // 内存与实际分支数成正比, 远小于每个节点 16 个引用的稠密表
+    size_t dense_node = sizeof(HyperTree::Node) - sizeof(tree.root()->childs) + HyperTree::child_num_ * sizeof(HyperTree::Node*);
+    ASSERT_LT(tree.memory_usage(), tree.size() * dense_node);
+
+    HyperTree copy = tree.clone();
+    copy.optimize_layout(HyperTree::Layout::BFS);
+    for (const Point4& p : points) ASSERT_EQ(copy.find(p)->data, tree.find(p)->data);
+
+    // 线性副本的节点含有 Vector4d, 按 alignof 对齐存放
+    LinearOctree<Point4, double, 4> linear(tree);
+    ASSERT_EQ(linear.size(), tree.size());
+    linear.visual([](const LinearOctree<Point4, double, 4>::Node* node) {
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(&node->center) % alignof(Point4), 0u);
+    });
+    struct alignas(64) Wide { double value; };
+    AlignedVector<Wide> wides(3);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(wides.data()) % 64, 0u);
+}
+
+template <typename T, size_t DIM>
+static void check_box_kernel()
+{
+    // 取值只有 -1, 0, 1, 覆盖相等的边界情况
+    T v[4][DIM];
+    for (int code = 0; code < 6561; ++code) {
+        int c = code;
+        for (size_t k = 0; k < 4; ++k) {
+            for (size_t i = 0; i < DIM; ++i, c /= 3) v[k][i] = T(c % 3 - 1);
+        }
+        ASSERT_EQ((BoxKernel<T, DIM>::find_index(v[0], v[1])), (ScalarBoxKernel<T, DIM>::find_index(v[0], v[1])));
+        ASSERT_EQ((BoxKernel<T, DIM>::is_in(v[0], v[1], v[2])), (ScalarBoxKernel<T, DIM>::is_in(v[0], v[1], v[2])));
+        ASSERT_EQ((BoxKernel<T, DIM>::overlap(v[0], v[1], v[2], v[3])), (ScalarBoxKernel<T, DIM>::overlap(v[0], v[1], v[2], v[3])));
+    }
+}
+
+TEST(octree, box_kernel)
+{
+    check_box_kernel<double, 2>();
+    check_box_kernel<double, 3>();
+    check_box_kernel<float, 2>();
+    check_box_kernel<float, 3>();
+
+    // 需要 32 字节对齐的节点中心
+    using Point4 = Eigen::Vector4d;
+    using AlignedTree = Octree<Point4, double, 3>;
+    std::unique_ptr<AlignedTree> tree(new AlignedTree(Point4(0, 0, 0, 0), Point4(8, 8, 8, 0), 4));
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(tree.get()) % alignof(AlignedTree), 0u);
+    for (int i = 0; i < 64; ++i) tree->insert(Point4(i % 8 + 0.5, i / 8 + 0.5, (i * 5) % 8 + 0.5, 0), 1);
+    std::function<void(AlignedTree::Node*)> check = [](AlignedTree::Node* node) {
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(node) % alignof(AlignedTree::Node), 0u);
+    };
+    tree->query_box(Point4(0, 0, 0, 0), Point4(8, 8, 8, 0), check);
+    ASSERT_EQ(tree->find(Point4(1.5, 0.5, 5.5, 0))->depth, 3u);
+}
+
+TEST(octree, set_operation)
+{
+    Quad obstacles(Point(0, 0), Point(64, 64), 5), mask(Point(0, 0), Point(64, 64), 5);
+    for (int i = 0; i < 400; ++i) obstacles.insert(Point((i * 13) % 64, (i * 29) % 64), 1);
+    // 掩膜的左下角是满子树
+    for (int x = 0; x < 32; x += 2) for (int y = 0; y < 32; y += 2) mask.insert(Point(x + 1, y + 1), 1);
+    for (int i = 0; i < 50; ++i) mask.insert(Point(32 + (i * 5) % 32, (i * 3) % 64), 1);
+
+    std::vector<std::pair<double, double>> a = leaves(obstacles), b = leaves(mask), expect;
+    Quad result = unite(obstacles, mask);
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expect));
+    ASSERT_TRUE(leaves(result) == expect);
+
+    expect.clear();
+    result = intersect(obstacles, mask);
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expect));
+    ASSERT_TRUE(leaves(result) == expect);
+
+    expect.clear();
+    result = subtract(obstacles, mask);
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expect));
+    ASSERT_TRUE(leaves(result) == expect);
+    ASSERT_EQ(result.find(Point(10, 10), 1)->data, 0);
+
+    // 中间节点的数据等于子节点之和
+    result.visual([&](Quad::Node* node) {
+        if (node->depth == 0 || node->depth + 1 == result.max_depth()) return;
+        double sum = 0;
+        for (size_t i = 0; i < Quad::child_num_; ++i) if (result.child(node, i)) sum += result.child(node, i)->data;
+        ASSERT_EQ(node->data, sum);
+    });
+}
+
+TEST(octree, memory_limit)
+{
+    const size_t limit = 300 * sizeof(Quad::Node);
+    Quad quadtree(Point(0, 0), Point(64, 64), 8);
+    quadtree.set_memory_limit(limit);
+
+    for (int i = 0; i < 3000; ++i) {
+        quadtree.insert(Point((i * 13) % 64 + 0.25, (i * 29) % 64 + 0.25), 1);
+        quadtree.insert(Point(60.5, 60.5), 1);  // 热点区域一直被访问
+        ASSERT_LE(quadtree.size() * sizeof(Quad::Node), limit);
+    }
+
+    // 合并损失分辨率但不损失总量
+    double total = 0;
+    quadtree.visual([&total](Quad::Node* node) { if (node->depth == 1) total += node->data; });
+    ASSERT_EQ(total, 6000);
+    ASSERT_EQ(quadtree.find(Point(60.5, 60.5))->depth, 7u);
+    ASSERT_LT(quadtree.find(Point(0.25, 0.25))->depth, 7u);
+
+    // 不限制内存时查找不写节点
+    Quad plain(Point(0, 0), Point(64, 64), 8);
+    for (int i = 0; i < 500; ++i) plain.insert(Point((i * 13) % 64 + 0.25, (i * 29) % 64 + 0.25), 1);
+    std::vector<uint32_t> stamps;
+    plain.visual([&stamps](Quad::Node* node) { stamps.push_back(node->stamp); });
+    for (int i = 0; i < 500; ++i) plain.find(Point((i * 7) % 64 + 0.5, (i * 11) % 64 + 0.5));
+    Eigen::Matrix2Xd points(2, 100);
+    for (int j = 0; j < 100; ++j) points.col(j) << (j * 17) % 64 + 0.5, (j * 5) % 64 + 0.5;
+    std::vector<Quad::Node*> nodes(100);
+    plain.find_batch(points, nodes.data(), 7);
+    plain.set_hash_index(true);
+    plain.find(Point(1.25, 2.25));
+    size_t k = 0;
+    plain.visual([&stamps, &k](Quad::Node* node) { ASSERT_EQ(node->stamp, stamps[k++]); });
+    ASSERT_EQ(k, stamps.size());
+
+    // 设置上限后查找刷新路径上的访问时刻
+    plain.set_memory_limit(limit * 10);
+    uint32_t stamp = plain.find(Point(1.25, 2.25))->stamp;
+    ASSERT_GT(plain.find(Point(1.25, 2.25))->stamp, stamp);
+}
+
+TEST(octree, changed_since)
+{
+    Quad quadtree(Point(0, 0), Point(64, 64), 6);
+    for (int i = 0; i < 500; ++i) quadtree.insert(Point((i * 13) % 64, (i * 29) % 64), 1);
+
+    size_t changed = 0;
+    std::function<void(Quad::Node*)> count = [&changed](Quad::Node*) { ++changed; };
+    quadtree.for_each_changed_since(0, count);
+    ASSERT_EQ(changed, quadtree.size());
+
+    // 只访问从根到新插入叶子的路径
+    uint32_t version = quadtree.checkpoint();
+    quadtree.insert(Point(60.5, 0.5), 1);
+    changed = 0;
+    quadtree.for_each_changed_since(version, count);
+    ASSERT_EQ(changed, quadtree.max_depth());
+
+    // 读取版本号不开始新版本
+    ASSERT_EQ(quadtree.version(), version + 1);
+    ASSERT_EQ(quadtree.version(), version + 1);
+
+    version = quadtree.checkpoint();
+    changed = 0;
+    quadtree.for_each_changed_since(version, count);
+    ASSERT_EQ(changed, 0u);
+
+    // 合并子树后, 被合并的节点和它的祖先被标记
+    quadtree.coarsen((quadtree.size() - 1) * sizeof(Quad::Node));
+    quadtree.for_each_changed_since(version, count);
+    ASSERT_GT(changed, 0u);
+    ASSERT_LT(changed, quadtree.max_depth());
+}
+
 static void draw_rec(double x_min, double x_max, double y_min, double y_max, signalsmith::plot::Plot2D &plot, Quad::Node *node)
 {
     std::vector<double> x = {x_min, x_max, x_max, x_min, x_min};
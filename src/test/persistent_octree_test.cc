@@ -0,0 +1,100 @@
+#include "core/tt_test.h"
+#include "octree/persistent_octree.h"
+#include <Eigen/Core>
+#include <algorithm>
+
+using Point = Eigen::Vector2d;
+using Version = PersistentQuadTree<Point, double>;
+
+TEST(persistent_octree, test)
+{
+    Octree<Point, double, 2> tree(Point(0, 0), Point(64, 64), 5);
+    for (int i = 0; i < 200; ++i) tree.insert(Point((i * 13) % 64, (i * 29) % 64), 1);
+
+    Version v1(tree);
+    Version v2 = v1.with_insert(Point(60, 60), 10);
+
+    // 旧版本不变, 新版本包含新插入的点
+    ASSERT_EQ(v1.find(Point(60, 60))->data, tree.find(Point(60, 60))->data);
+    ASSERT_EQ(v2.find(Point(60, 60))->data, tree.find(Point(60, 60))->data + 10);
+    ASSERT_EQ(v2.find(Point(60, 60), 1)->data, v1.find(Point(60, 60), 1)->data + 10);
+
+    // 只复制插入路径, 其他子树共享
+    ASSERT_NE(v1.root(), v2.root());
+    ASSERT_NE(v1.root()->childs[3].get(), v2.root()->childs[3].get());
+    for (size_t i = 0; i < 3; ++i) ASSERT_EQ(v1.root()->childs[i].get(), v2.root()->childs[i].get());
+
+    size_t v1_nodes = 0, v2_nodes = 0;
+    v1.visual([&v1_nodes](const Version::Node*) { ++v1_nodes; });
+    v2.visual([&v2_nodes](const Version::Node*) { ++v2_nodes; });
+    ASSERT_GE(v2_nodes, v1_nodes);
+}
+
+TEST(persistent_octree, coord_type)
+{
+    // 源树使用定点内部坐标, 节点中心转换回 PosType 后与默认坐标的树相同
+    Octree<Point, double, 2> tree(Point(0, 0), Point(64, 64), 5);
+    Octree<Point, double, 2, PointerRef, Eigen::Vector2i> fixed(Point(0, 0), Point(64, 64), 5);
+    for (int i = 0; i < 200; ++i) {
+        tree.insert(Point((i * 13) % 64 + 0.5, (i * 29) % 64 + 0.5), 1);
+        fixed.insert(Point((i * 13) % 64 + 0.5, (i * 29) % 64 + 0.5), 1);
+    }
+
+    Version v1(fixed), expect(tree);
+    for (int i = 0; i < 200; ++i) {
+        Point p((i * 7) % 64 + 0.25, (i * 11) % 64 + 0.25);
+        ASSERT_EQ(v1.find(p)->center, expect.find(p)->center);
+        ASSERT_EQ(v1.find(p)->data, expect.find(p)->data);
+    }
+    Version v2 = v1.with_insert(Point(60.5, 60.5), 10);
+    ASSERT_EQ(v2.find(Point(60.5, 60.5))->data, tree.find(Point(60.5, 60.5))->data + 10);
+}
+
+TEST(persistent_octree, boundary)
+{
+    // 新版本的节点中心和边界与 Octree 使用同一张半尺寸表, 深度超过 31 层时也一致
+    Octree<Point, double, 2> tree(Point(-3, 5), Point(7, 6), 40);
+    Point p(1.2345, 5.4321);
+    tree.insert(p, 1);
+    Version version = Version(Point(-3, 5), Point(7, 6), 40).with_insert(p, 1);
+    for (size_t depth = 0; depth < 40; ++depth) {
+        Version::Boundary expect, boundary;
+        tree.find_boundary(tree.find(p, depth), expect);
+        version.find_boundary(version.find(p, depth), boundary);
+        ASSERT_EQ(version.find(p, depth)->center, tree.find(p, depth)->center);
+        ASSERT_TRUE(boundary.min == expect.min && boundary.max == expect.max);
+    }
+}
+
+/**
+ * @brief 	 [简介] 重写了 update 的树: 取最大值
+ */
+class MaxTree : public Octree<Point, double, 2> {
+public:
+    using Octree<Point, double, 2>::Octree;
+protected:
+    double update(double& old_data, const double& new_data) override { return std::max(old_data, new_data); }
+};
+
+TEST(persistent_octree, update)
+{
+    // 插入路径上的数据经过构造时给出的更新方法, 结果与重写了 update 的 Octree 相同
+    MaxTree tree(Point(0, 0), Point(64, 64), 5);
+    for (int i = 0; i < 100; ++i) tree.insert(Point((i * 13) % 64 + 0.5, (i * 29) % 64 + 0.5), i % 7);
+    auto max = [](const double& old_data, const double& new_data) { return std::max(old_data, new_data); };
+    Version version(tree, max);
+    for (int i = 0; i < 100; ++i) {
+        Point p((i * 7) % 64 + 0.5, (i * 11) % 64 + 0.5);
+        tree.insert(p, i % 5);
+        version = version.with_insert(p, i % 5);
+    }
+    for (int i = 0; i < 200; ++i) {
+        Point p((i * 13) % 64 + 0.5, (i * 3) % 64 + 0.5);
+        for (size_t depth = 1; depth < 5; ++depth) ASSERT_EQ(version.find(p, depth)->data, tree.find(p, depth)->data);
+    }
+
+    // 默认为加法
+    Version sum(Point(0, 0), Point(64, 64), 5);
+    sum = sum.with_insert(Point(1, 1), 2).with_insert(Point(1, 1), 3);
+    ASSERT_EQ(sum.find(Point(1, 1))->data, 5.0);
+}
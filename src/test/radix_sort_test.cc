@@ -0,0 +1,57 @@
+#include "core/tt_test.h"
+#include "core/tt_radix_sort.h"
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 	 [简介] 与 std::stable_sort 的结果比较, 负载为原始下标
+ */
+template <typename Key>
+static bool check_radix_sort(std::vector<Key> keys, size_t key_bits, size_t threads)
+{
+    std::vector<std::pair<Key, uint32_t>> expect(keys.size());
+    for (size_t j = 0; j < keys.size(); ++j) expect[j] = std::make_pair(keys[j], uint32_t(j));
+    std::stable_sort(expect.begin(), expect.end(), [](const std::pair<Key, uint32_t>& a, const std::pair<Key, uint32_t>& b) {
+        return a.first < b.first;
+    });
+
+    std::vector<uint32_t> ids(keys.size());
+    for (size_t j = 0; j < ids.size(); ++j) ids[j] = uint32_t(j);
+    radix_sort(keys.data(), ids.data(), keys.size(), key_bits, threads);
+    for (size_t j = 0; j < keys.size(); ++j) {
+        if (keys[j] != expect[j].first || ids[j] != expect[j].second) return false;
+    }
+    return true;
+}
+
+TEST(radix_sort, test)
+{
+    std::mt19937_64 rng(1);
+    for (size_t num : {0, 1, 7, 1000, 100000}) {
+        std::vector<uint64_t> keys64(num);
+        std::vector<uint32_t> keys32(num), narrow(num);
+        for (size_t j = 0; j < num; ++j) {
+            keys64[j] = rng();
+            keys32[j] = uint32_t(rng());
+            narrow[j] = uint32_t(rng() % 64);   // 大量重复键, 检查稳定性
+        }
+        for (size_t threads : {1, 4}) {
+            ASSERT_TRUE(check_radix_sort(keys64, 64, threads));
+            ASSERT_TRUE(check_radix_sort(keys32, 32, threads));
+            ASSERT_TRUE(check_radix_sort(narrow, 6, threads));
+        }
+    }
+
+    // 全部相同的键: 每一趟都被跳过
+    ASSERT_TRUE(check_radix_sort(std::vector<uint64_t>(50000, 42), 64, 4));
+
+    // 只有键, 没有负载
+    std::vector<uint64_t> keys(70000);
+    for (uint64_t& key : keys) key = rng() >> 20;
+    std::vector<uint64_t> expect = keys;
+    std::sort(expect.begin(), expect.end());
+    radix_sort(keys.data(), keys.size(), 44, 3);
+    ASSERT_TRUE(keys == expect);
+}
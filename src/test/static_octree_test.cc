@@ -0,0 +1,31 @@
+#include "core/tt_test.h"
+#include "octree/static_octree.h"
+#include <Eigen/Core>
+
+using Point = Eigen::Vector3d;
+using Tree = OctTree<Point, float>;
+using Static = StaticOctTree<Point, float, 7>;
+
+TEST(static_octree, test)
+{
+    Tree tree(Point(0, 0, 0), Point(64, 64, 64), 7);
+    Static fixed(Point(0, 0, 0), Point(64, 64, 64));
+    for (int i = 0; i < 20000; ++i) {
+        Point p((i * 13) % 64 + 0.5, (i * 29) % 64 + 0.5, (i * 7) % 61 + 0.5);
+        tree.insert(p, 1);
+        fixed.insert(p, 1);
+    }
+    ASSERT_EQ(fixed.size(), tree.size());
+    ASSERT_EQ(fixed.max_depth(), 7u);
+
+    for (int i = 0; i < 1000; ++i) {
+        Point p((i * 17) % 64 + 0.3, (i * 5) % 64 + 0.3, (i * 11) % 64 + 0.3);
+        Static::Node *node = fixed.find(p);
+        Tree::Node *expect = tree.find(p);
+        ASSERT_EQ(node->depth, expect->depth);
+        ASSERT_EQ(node->center, expect->center);
+        ASSERT_EQ(node->data, expect->data);
+        ASSERT_EQ(fixed.find_key(p), tree.find_key(p, 6));
+        ASSERT_EQ(fixed.find(p, 3)->depth, tree.find(p, 3)->depth);
+    }
+}
@@ -0,0 +1,83 @@
+#include "core/tt_test.h"
+#include "octree/succinct_octree.h"
+#include <Eigen/Core>
+
+using Point = Eigen::Vector3d;
+using Tree = OctTree<Point, float>;
+using Succinct = SuccinctOctree<Point, float, 3>;
+
+TEST(succinct_octree, test)
+{
+    Tree tree(Point(0, 0, 0), Point(64, 64, 64), 7);
+    for (int i = 0; i < 20000; ++i) tree.insert(Point((i * 13) % 64 + 0.5, (i * 29) % 64 + 0.5, (i * 7) % 61 + 0.5), 1);
+
+    Succinct succinct(tree);
+    ASSERT_EQ(succinct.size(), tree.size());
+    ASSERT_LT(succinct.memory_usage() * 4, tree.size() * sizeof(Tree::Node));
+
+    for (int i = 0; i < 1000; ++i) {
+        Point p((i * 17) % 64 + 0.3, (i * 5) % 64 + 0.3, (i * 11) % 64 + 0.3);
+        for (size_t depth : {size_t(2), size_t(7)}) {
+            Succinct::Node node = succinct.find(p, depth);
+            Tree::Node *expect = tree.find(p, depth);
+            ASSERT_EQ(node.depth, expect->depth);
+            ASSERT_EQ(node.center, expect->center);
+            ASSERT_EQ(node.data, expect->data);
+            if (node.id != 0) ASSERT_EQ(succinct.find(p, node.depth - 1).id, succinct.parent(node.id));
+        }
+    }
+
+    float box = 0, box_expect = 0;
+    succinct.query_box(Point(10, 10, 10), Point(30, 40, 50), [&box](const Succinct::Node& node) { box += node.data; });
+    tree.query_box(Point(10, 10, 10), Point(30, 40, 50), [&box_expect](Tree::Node* node) { box_expect += node->data; });
+    ASSERT_EQ(box, box_expect);
+    ASSERT_GT(box, 0);
+
+    size_t count = 0, count_expect = 0;
+    succinct.query_radius(Point(32, 32, 32), 12, [&count](const Succinct::Node&) { ++count; }, 4);
+    tree.query_radius(Point(32, 32, 32), 12, [&count_expect](Tree::Node*) { ++count_expect; }, 4);
+    ASSERT_EQ(count, count_expect);
+    ASSERT_GT(count, 0u);
+}
+
+TEST(succinct_octree, coord_type)
+{
+    // 源树使用 float 内部坐标, 副本的节点中心转换回 PosType
+    using FloatTree = Octree<Point, float, 3, PointerRef, Eigen::Vector3f>;
+    Tree tree(Point(0, 0, 0), Point(64, 64, 64), 6);
+    FloatTree float_tree(Point(0, 0, 0), Point(64, 64, 64), 6);
+    for (int i = 0; i < 3000; ++i) {
+        Point p((i * 13) % 64 + 0.5, (i * 29) % 64 + 0.5, (i * 7) % 61 + 0.5);
+        tree.insert(p, 1);
+        float_tree.insert(p, 1);
+    }
+
+    Succinct succinct(float_tree), expect(tree);
+    ASSERT_EQ(succinct.size(), expect.size());
+    for (int i = 0; i < 500; ++i) {
+        Point p((i * 17) % 64 + 0.3, (i * 5) % 64 + 0.3, (i * 11) % 64 + 0.3);
+        Succinct::Node node = succinct.find(p), node_expect = expect.find(p);
+        ASSERT_EQ(node.id, node_expect.id);
+        ASSERT_EQ(node.center, node_expect.center);
+        ASSERT_EQ(node.data, node_expect.data);
+    }
+}
+
+TEST(succinct_octree, boundary)
+{
+    // 节点中心和边界取自源树的半尺寸表, 深度超过 31 层时也与源树一致
+    using Quad = Octree<Eigen::Vector2d, float, 2>;
+    Quad tree(Eigen::Vector2d(-3, 5), Eigen::Vector2d(7, 6), 40);
+    Eigen::Vector2d p(1.2345, 5.4321);
+    tree.insert(p, 1);
+    SuccinctOctree<Eigen::Vector2d, float, 2> succinct(tree);
+    for (size_t depth = 0; depth < 40; ++depth) {
+        Quad::Boundary expect, boundary;
+        tree.find_boundary(tree.find(p, depth), expect);
+        auto node = succinct.find(p, depth);
+        succinct.find_boundary(node, boundary);
+        ASSERT_EQ(node.depth, depth);
+        ASSERT_EQ(node.center, tree.find(p, depth)->center);
+        ASSERT_TRUE(boundary.min == expect.min && boundary.max == expect.max);
+    }
+}
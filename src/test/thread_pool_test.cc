@@ -0,0 +1,70 @@
+#include "core/tt_test.h"
+#include "core/tt_thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+static uint64_t fib(ThreadPool& pool, uint64_t n)
+{
+    if (n < 12) return n < 2 ? n : fib(pool, n - 1) + fib(pool, n - 2);
+    uint64_t a = 0;
+    TaskGroup group(pool);
+    group.spawn([&pool, &a, n]() { a = fib(pool, n - 1); });
+    uint64_t b = fib(pool, n - 2);
+    group.sync();
+    return a + b;
+}
+
+TEST(thread_pool, test)
+{
+    ThreadPool pool(3);
+    ASSERT_EQ(pool.size(), 3u);
+
+    // parallel_for 覆盖每个下标恰好一次
+    std::vector<int> hits(100000, 0);
+    pool.parallel_for(0, hits.size(), 0, [&hits](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) ++hits[i];
+    });
+    ASSERT_EQ(std::accumulate(hits.begin(), hits.end(), 0), int(hits.size()));
+    ASSERT_EQ(*std::min_element(hits.begin(), hits.end()), 1);
+
+    // parallel_reduce 按 (左, 右) 合并: 用字符串拼接检查顺序
+    std::string digits = pool.parallel_reduce(0, 1000, 7, std::string(), [](size_t lo, size_t hi) {
+        std::string s;
+        for (size_t i = lo; i < hi; ++i) s += char('0' + i % 10);
+        return s;
+    }, [](const std::string& a, const std::string& b) { return a + b; });
+    ASSERT_EQ(digits.size(), 1000u);
+    for (size_t i = 0; i < digits.size(); ++i) ASSERT_EQ(digits[i], char('0' + i % 10));
+    ASSERT_EQ(pool.parallel_reduce(5, 5, 1, 42, [](size_t, size_t) { return 0; }, [](int a, int b) { return a + b; }), 42);
+
+    // 递归 spawn/sync, 任务中再次 sync 不会死锁
+    ASSERT_EQ(fib(pool, 25), 75025u);
+
+    // 嵌套的 parallel_for, 外层任务在工作线程上执行, 内层任务放入工作线程自己的队列
+    std::atomic<size_t> total(0);
+    std::mutex mutex;
+    std::set<std::thread::id> ids;
+    pool.parallel_for(0, 64, 1, [&](size_t, size_t) {
+        pool.parallel_for(0, 1000, 10, [&](size_t lo, size_t hi) {
+            total += hi - lo;
+            std::lock_guard<std::mutex> lock(mutex);
+            ids.insert(std::this_thread::get_id());
+        });
+    });
+    ASSERT_EQ(total.load(), 64000u);
+    ASSERT_GE(ids.size(), 1u);
+
+    // 共享线程池和默认的任务组
+    std::atomic<int> count(0);
+    {
+        TaskGroup group;
+        for (int i = 0; i < 100; ++i) group.spawn([&count]() { ++count; });
+    }
+    ASSERT_EQ(count.load(), 100);
+}